@@ -1,5 +1,7 @@
 #include <GL4D/gl4dh.h>
 #include "audioHelper.h"
+#include "variantHelper.h"
+#include "stateHelper.h"
 #include <assert.h>
 #include <stdlib.h>
 #include <GL4D/gl4dg.h>
@@ -26,6 +28,10 @@ static void loadTexture(GLuint id, const char * filename) {
 
 /*!\brief identifiant de la géométrie QUAD GL4Dummies */
 static GLuint _quadId = 0;
+/*!\brief uniforms des programmes de mélange, relevés par chaque
+ * transition à son initialisation */
+enum { U_DT = 0, U_TEX0, U_TEX1, U_TEX2, U_NB };
+static const char * const _uNames[U_NB] = { "dt", "tex0", "tex1", "tex2" };
 
 void transition_vide(void (* a0)(int), void (* a1)(int), Uint32 t, Uint32 et, int state) {
   /* INITIALISEZ VOS VARIABLES */
@@ -55,6 +61,7 @@ void fondu(void (* a0)(int), void (* a1)(int), Uint32 t, Uint32 et, int state) {
   int vp[4], i;
   GLint tId;
   static GLuint tex[2], pId;
+  static GLint u[U_NB];
   switch(state) {
   case GL4DH_INIT:
     /* INITIALISEZ VOTRE TRANSITION (SES VARIABLES <STATIC>s) */
@@ -68,7 +75,8 @@ void fondu(void (* a0)(int), void (* a1)(int), Uint32 t, Uint32 et, int state) {
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
       glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, vp[2], vp[3], 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
     }
-    pId = gl4duCreateProgram("<vs>shaders/basic.vs", "<fs>shaders/mix.fs", NULL);
+    pId = vhProgram("shaders/basic.vs", "shaders/mix.fs", NULL);
+    vhUniforms(pId, _uNames, U_NB, u);
     return;
   case GL4DH_FREE:
     /* LIBERER LA MEMOIRE UTILISEE PAR LES <STATIC>s */
@@ -84,32 +92,32 @@ void fondu(void (* a0)(int), void (* a1)(int), Uint32 t, Uint32 et, int state) {
     return;
   default: /* GL4DH_DRAW */
     /* RECUPERER L'ID DE LA DERNIERE TEXTURE ATTACHEE AU FRAMEBUFFER */
-    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME, &tId);
+    tId = shFramebufferTexture(GL_COLOR_ATTACHMENT0);
     /* JOUER LES DEUX ANIMATIONS */
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[0],  0);
+    shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[0],  0);
     if(a0) a0(state);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[1],  0);
+    shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[1],  0);
     if(a1) a1(state);
     /* MIXER LES DEUX ANIMATIONS */
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tId,  0);
+    shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tId,  0);
     glDisable(GL_DEPTH);
-    glUseProgram(pId);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex[0]);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, tex[1]);
+    shUseProgram(pId);
+    shActiveTexture(GL_TEXTURE0);
+    shBindTexture(GL_TEXTURE_2D, tex[0]);
+    shActiveTexture(GL_TEXTURE1);
+    shBindTexture(GL_TEXTURE_2D, tex[1]);
     if(et / (GLfloat)t > 1) {
       fprintf(stderr, "%d-%d -- %f\n", et, t, et / (GLfloat)t);
       exit(0);
     }
-    glUniform1f(glGetUniformLocation(pId, "dt"), et / (GLfloat)t);
-    glUniform1i(glGetUniformLocation(pId, "tex0"), 0);
-    glUniform1i(glGetUniformLocation(pId, "tex1"), 1);
+    glUniform1f(u[U_DT], et / (GLfloat)t);
+    glUniform1i(u[U_TEX0], 0);
+    glUniform1i(u[U_TEX1], 1);
     gl4dgDraw(_quadId);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    shActiveTexture(GL_TEXTURE1);
+    shBindTexture(GL_TEXTURE_2D, 0);
+    shActiveTexture(GL_TEXTURE0);
+    shBindTexture(GL_TEXTURE_2D, 0);
     return;
   }
 }
@@ -119,6 +127,7 @@ void fondud(void (* a0)(int), void (* a1)(int), Uint32 t, Uint32 et, int state)
   int vp[4], i;
   GLint tId;
   static GLuint tex[3], pId;
+  static GLint u[U_NB];
   switch(state) {
   case GL4DH_INIT:
     /* INITIALISEZ VOTRE TRANSITION (SES VARIABLES <STATIC>s) */
@@ -133,7 +142,8 @@ void fondud(void (* a0)(int), void (* a1)(int), Uint32 t, Uint32 et, int state)
       glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, vp[2], vp[3], 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
     }
     loadTexture(tex[2], "images/fondu_d.jpg");
-    pId = gl4duCreateProgram("<vs>shaders/basic.vs", "<fs>shaders/mixi.fs", NULL);
+    pId = vhProgram("shaders/basic.vs", "shaders/mixi.fs", NULL);
+    vhUniforms(pId, _uNames, U_NB, u);
     return;
   case GL4DH_FREE:
     /* LIBERER LA MEMOIRE UTILISEE PAR LES <STATIC>s */
@@ -149,37 +159,37 @@ void fondud(void (* a0)(int), void (* a1)(int), Uint32 t, Uint32 et, int state)
     return;
   default: /* GL4DH_DRAW */
     /* RECUPERER L'ID DE LA DERNIERE TEXTURE ATTACHEE AU FRAMEBUFFER */
-    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME, &tId);
+    tId = shFramebufferTexture(GL_COLOR_ATTACHMENT0);
     /* JOUER LES DEUX ANIMATIONS */
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[0],  0);
+    shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[0],  0);
     if(a0) a0(state);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[1],  0);
+    shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[1],  0);
     if(a1) a1(state);
     /* MIXER LES DEUX ANIMATIONS */
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tId,  0);
+    shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tId,  0);
     glDisable(GL_DEPTH);
-    glUseProgram(pId);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex[0]);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, tex[1]);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, tex[2]);
+    shUseProgram(pId);
+    shActiveTexture(GL_TEXTURE0);
+    shBindTexture(GL_TEXTURE_2D, tex[0]);
+    shActiveTexture(GL_TEXTURE1);
+    shBindTexture(GL_TEXTURE_2D, tex[1]);
+    shActiveTexture(GL_TEXTURE2);
+    shBindTexture(GL_TEXTURE_2D, tex[2]);
     if(et / (GLfloat)t > 1) {
       fprintf(stderr, "%d-%d -- %f\n", et, t, et / (GLfloat)t);
       exit(0);
     }
-    glUniform1f(glGetUniformLocation(pId, "dt"), et / (GLfloat)t * 2);
-    glUniform1i(glGetUniformLocation(pId, "tex0"), 0);
-    glUniform1i(glGetUniformLocation(pId, "tex1"), 1);
-    glUniform1i(glGetUniformLocation(pId, "tex2"), 2);
+    glUniform1f(u[U_DT], et / (GLfloat)t * 2);
+    glUniform1i(u[U_TEX0], 0);
+    glUniform1i(u[U_TEX1], 1);
+    glUniform1i(u[U_TEX2], 2);
     gl4dgDraw(_quadId);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    shActiveTexture(GL_TEXTURE2);
+    shBindTexture(GL_TEXTURE_2D, 0);
+    shActiveTexture(GL_TEXTURE1);
+    shBindTexture(GL_TEXTURE_2D, 0);
+    shActiveTexture(GL_TEXTURE0);
+    shBindTexture(GL_TEXTURE_2D, 0);
     return;
   }
 }
@@ -189,6 +199,7 @@ void fondu_enc(void (* a0)(int), void (* a1)(int), Uint32 t, Uint32 et, int stat
   int vp[4], i;
   GLint tId;
   static GLuint tex[3], pId;
+  static GLint u[U_NB];
   switch(state) {
   case GL4DH_INIT:
     /* INITIALISEZ VOTRE TRANSITION (SES VARIABLES <STATIC>s) */
@@ -203,7 +214,8 @@ void fondu_enc(void (* a0)(int), void (* a1)(int), Uint32 t, Uint32 et, int stat
       glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, vp[2], vp[3], 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
     }
     loadTexture(tex[2], "images/fondu_enc.jpg");
-    pId = gl4duCreateProgram("<vs>shaders/basic.vs", "<fs>shaders/mixi.fs", NULL);
+    pId = vhProgram("shaders/basic.vs", "shaders/mixi.fs", NULL);
+    vhUniforms(pId, _uNames, U_NB, u);
     return;
   case GL4DH_FREE:
     /* LIBERER LA MEMOIRE UTILISEE PAR LES <STATIC>s */
@@ -219,37 +231,37 @@ void fondu_enc(void (* a0)(int), void (* a1)(int), Uint32 t, Uint32 et, int stat
     return;
   default: /* GL4DH_DRAW */
     /* RECUPERER L'ID DE LA DERNIERE TEXTURE ATTACHEE AU FRAMEBUFFER */
-    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME, &tId);
+    tId = shFramebufferTexture(GL_COLOR_ATTACHMENT0);
     /* JOUER LES DEUX ANIMATIONS */
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[0],  0);
+    shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[0],  0);
     if(a0) a0(state);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[1],  0);
+    shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[1],  0);
     if(a1) a1(state);
     /* MIXER LES DEUX ANIMATIONS */
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tId,  0);
+    shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tId,  0);
     glDisable(GL_DEPTH);
-    glUseProgram(pId);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex[0]);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, tex[1]);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, tex[2]);
+    shUseProgram(pId);
+    shActiveTexture(GL_TEXTURE0);
+    shBindTexture(GL_TEXTURE_2D, tex[0]);
+    shActiveTexture(GL_TEXTURE1);
+    shBindTexture(GL_TEXTURE_2D, tex[1]);
+    shActiveTexture(GL_TEXTURE2);
+    shBindTexture(GL_TEXTURE_2D, tex[2]);
     if(et / (GLfloat)t > 1) {
       fprintf(stderr, "%d-%d -- %f\n", et, t, et / (GLfloat)t);
       exit(0);
     }
-    glUniform1f(glGetUniformLocation(pId, "dt"), et / (GLfloat)t * 2);
-    glUniform1i(glGetUniformLocation(pId, "tex0"), 0);
-    glUniform1i(glGetUniformLocation(pId, "tex1"), 1);
-    glUniform1i(glGetUniformLocation(pId, "tex2"), 2);
+    glUniform1f(u[U_DT], et / (GLfloat)t * 2);
+    glUniform1i(u[U_TEX0], 0);
+    glUniform1i(u[U_TEX1], 1);
+    glUniform1i(u[U_TEX2], 2);
     gl4dgDraw(_quadId);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    shActiveTexture(GL_TEXTURE2);
+    shBindTexture(GL_TEXTURE_2D, 0);
+    shActiveTexture(GL_TEXTURE1);
+    shBindTexture(GL_TEXTURE_2D, 0);
+    shActiveTexture(GL_TEXTURE0);
+    shBindTexture(GL_TEXTURE_2D, 0);
     return;
   }
 }
@@ -259,6 +271,7 @@ void fondui(void (* a0)(int), void (* a1)(int), Uint32 t, Uint32 et, int state)
   int vp[4], i;
   GLint tId;
   static GLuint tex[3], pId;
+  static GLint u[U_NB];
   switch(state) {
   case GL4DH_INIT:
     /* INITIALISEZ VOTRE TRANSITION (SES VARIABLES <STATIC>s) */
@@ -273,7 +286,8 @@ void fondui(void (* a0)(int), void (* a1)(int), Uint32 t, Uint32 et, int state)
       glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, vp[2], vp[3], 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
     }
     loadTexture(tex[2], "images/fondui.jpg");
-    pId = gl4duCreateProgram("<vs>shaders/basic.vs", "<fs>shaders/mixi.fs", NULL);
+    pId = vhProgram("shaders/basic.vs", "shaders/mixi.fs", NULL);
+    vhUniforms(pId, _uNames, U_NB, u);
     return;
   case GL4DH_FREE:
     /* LIBERER LA MEMOIRE UTILISEE PAR LES <STATIC>s */
@@ -289,37 +303,37 @@ void fondui(void (* a0)(int), void (* a1)(int), Uint32 t, Uint32 et, int state)
     return;
   default: /* GL4DH_DRAW */
     /* RECUPERER L'ID DE LA DERNIERE TEXTURE ATTACHEE AU FRAMEBUFFER */
-    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME, &tId);
+    tId = shFramebufferTexture(GL_COLOR_ATTACHMENT0);
     /* JOUER LES DEUX ANIMATIONS */
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[0],  0);
+    shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[0],  0);
     if(a0) a0(state);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[1],  0);
+    shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tex[1],  0);
     if(a1) a1(state);
     /* MIXER LES DEUX ANIMATIONS */
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tId,  0);
+    shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,  tId,  0);
     glDisable(GL_DEPTH);
-    glUseProgram(pId);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex[0]);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, tex[1]);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, tex[2]);
+    shUseProgram(pId);
+    shActiveTexture(GL_TEXTURE0);
+    shBindTexture(GL_TEXTURE_2D, tex[0]);
+    shActiveTexture(GL_TEXTURE1);
+    shBindTexture(GL_TEXTURE_2D, tex[1]);
+    shActiveTexture(GL_TEXTURE2);
+    shBindTexture(GL_TEXTURE_2D, tex[2]);
     if(et / (GLfloat)t > 1) {
       fprintf(stderr, "%d-%d -- %f\n", et, t, et / (GLfloat)t);
       exit(0);
     }
-    glUniform1f(glGetUniformLocation(pId, "dt"), et / (GLfloat)t * 2);
-    glUniform1i(glGetUniformLocation(pId, "tex0"), 0);
-    glUniform1i(glGetUniformLocation(pId, "tex1"), 1);
-    glUniform1i(glGetUniformLocation(pId, "tex2"), 2);
+    glUniform1f(u[U_DT], et / (GLfloat)t * 2);
+    glUniform1i(u[U_TEX0], 0);
+    glUniform1i(u[U_TEX1], 1);
+    glUniform1i(u[U_TEX2], 2);
     gl4dgDraw(_quadId);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    shActiveTexture(GL_TEXTURE2);
+    shBindTexture(GL_TEXTURE_2D, 0);
+    shActiveTexture(GL_TEXTURE1);
+    shBindTexture(GL_TEXTURE_2D, 0);
+    shActiveTexture(GL_TEXTURE0);
+    shBindTexture(GL_TEXTURE_2D, 0);
     return;
   }
 }
@@ -5,8 +5,15 @@
 #include <SDL_mixer.h>
 #include <GL4D/gl4dh.h>
 #include "audioHelper.h"
+#include "lodHelper.h"
+#include "postHelper.h"
+#include "variantHelper.h"
+#include "stateHelper.h"
+#include "jobHelper.h"
 
 #define NTEXTURES 12
+/*!\brief nombre de mobiles par tranche de jhRun */
+#define MOBILE_GRAIN 64
 
 typedef struct mobile_t mobile_t;
 struct mobile_t {
@@ -22,7 +29,7 @@ static void         initData(void);
 static void         mobileInit(void);
 static void         draw(void);
 static float        myRand(float max);
-static void         mobile2texture(float * f);
+static void         mobileJob(int first, int last, void * data, jhList_t * list);
 static int          distance(int x0, int y0, int x1, int y1);
 static int          bestMove(mobile_t mobile);
 static void         quit(void);
@@ -33,7 +40,14 @@ enum { TEX_STAR00, TEX_STAR01, TEX_STAR02, TEX_STAR03, TEX_STAR04 };
 static int _w, _h;
 static GLuint _screen = 0;
 static GLuint _pId = 0;
+/*!\brief programme des mobiles instanciés et leur texture tableau */
+static GLuint _ipId = 0;
+static GLuint _taId = 0;
 static GLuint _tId[NTEXTURES] = {0};
+/*!\brief uniforms des deux programmes, relevés à l'initialisation */
+enum { U_TEX0 = 0, U_IMPOSTOR, U_NB };
+static const char * const _uNames[U_NB] = { "tex0", "impostor" };
+static GLint _u[U_NB], _iu[U_NB];
 
 static GLuint _sphere = {0};
 static GLuint _torus = 0;
@@ -43,11 +57,17 @@ static int _state = 0;
 static int _scale = 0;
 static int _swirl = 0;
 static int _direction = 0;
+/*!\brief post-traitement : le tourbillon, calculé en demi-résolution */
+static phChain_t * _post = NULL;
+static int _postSwirl = 0;
 
 static int _nb_mobiles = 220;
 static int _cur_mobile = 1;
 static int _white_mobiles = 1;
 static mobile_t * _mobile = NULL;
+/*!\brief positions et rayons des mobiles, alloués avec eux plutôt
+ * qu'à chaque frame */
+static GLfloat * _f = NULL;
 static int _cur_id = 0;
 
 static float _basses = 0;
@@ -64,9 +84,16 @@ static float myRand(float max) {
 }
 
 static void initGL(void) {
-  _pId  = gl4duCreateProgram("<vs>shaders/attraction.vs", "<fs>shaders/attraction.fs", NULL);
+  _pId  = vhProgram("shaders/attraction.vs", "shaders/attraction.fs", NULL);
+  _ipId = vhProgram("shaders/attraction.vs", "shaders/attraction.fs", "#define INSTANCED\n");
+  vhUniforms(_pId, _uNames, U_NB, _u);
+  vhUniforms(_ipId, _uNames, U_NB, _iu);
   gl4duGenMatrix(GL_FLOAT, "modelViewMatrix");
   gl4duGenMatrix(GL_FLOAT, "projectionMatrix");
+  lhInit();
+  jhInit();
+  _post = phNew();
+  _postSwirl = phAdd(_post, PH_SWIRL, 0.5f);
 }
 
 static void mobileInit(void) {
@@ -87,6 +114,10 @@ static void mobileInit(void) {
   }
   _mobile = malloc(_nb_mobiles * sizeof *_mobile);
   assert(_mobile);
+  if(_f)
+    free(_f);
+  _f = malloc(_nb_mobiles * 8 * sizeof *_f);
+  assert(_f);
 
   _mobile[0].r = 200;
   _mobile[0].x = _mobile[0].y = 0;
@@ -117,7 +148,7 @@ static void mobileInit(void) {
 static void initData(void) {
   int i;
   SDL_Surface * t;
-  static char * files[] = {
+  static const char * files[] = {
     "images/star00.png", 
     "images/star001.png", 
     "images/star002.png", 
@@ -134,7 +165,7 @@ static void initData(void) {
   };
   glGenTextures(NTEXTURES, _tId);
   for(i = 0; i < NTEXTURES; i++) {
-    glBindTexture(GL_TEXTURE_2D, _tId[i]);
+    shBindTexture(GL_TEXTURE_2D, _tId[i]);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     if( (t = IMG_Load(files[i])) != NULL ) {
@@ -147,19 +178,35 @@ static void initData(void) {
       glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
     }
   }
+  /* couche i = texture i, en taille réduite pour les mobiles */
+  if(!_taId)
+    _taId = lhTexArray(files, NTEXTURES, 512, 256);
   _sphere = gl4dgGenSpheref(30, 30);
   _torus = gl4dgGenTorusf(300, 30, 0.1f);
 
   mobileInit();
 }
 
-static void mobile2texture(float * f) {
+/*!\brief job de jhRun : range les mobiles [\a first, \a last[ dans
+ * \a data (_f) et, hors zoom, enregistre la sphère de chacun sauf le
+ * mobile 0, dessiné à part. */
+static void mobileJob(int first, int last, void * data, jhList_t * list) {
   int i;
-  for(i = 0; i < _nb_mobiles; i++) {
+  float * f = data;
+  for(i = first; i < last; i++) {
     f[8 * i + 0] = _mobile[i].x; 
     f[8 * i + 1] = _mobile[i].y;
     f[8 * i + 2] = _mobile[i].r / ((GLfloat)MIN(_w, _h));
     f[8 * i + 3] = 1;
+    if(i && !_scale) {
+      jhCmd_t * c = jhRecord(list);
+      c->t[0] = (f[8 * i + 0] * 3) / _w;
+      c->t[1] = (f[8 * i + 1] * 2) / _h;
+      c->t[2] = 0;
+      c->t[3] = f[8 * i + 2] * 0.2;
+      c->color[0] = c->color[1] = c->color[2] = c->color[3] = 1;
+      c->material = _mobile[i].texId;
+    }
   }
 }
 
@@ -220,11 +267,12 @@ static void init(int w, int h) {
 }
 
 static void draw(void) {
-  int i;
+  int i, j, n, lists;
+  const jhCmd_t * c;
   GLint vp[4];
   GLfloat *mat;
   GLfloat dt = 0.0;
-  GLfloat * f = malloc(_nb_mobiles * 8 * sizeof *f);
+  GLfloat * f = _f;
   static float lf = 0.0;
   static GLfloat a = 0.0, s[2] = { 0, 0 };
 
@@ -241,12 +289,13 @@ static void draw(void) {
       s[0] += 0.05;
     }
   }
-  GLboolean gdt = glIsEnabled(GL_DEPTH_TEST);
-  glGetIntegerv(GL_VIEWPORT, vp);
+  GLboolean gdt = shIsEnabled(GL_DEPTH_TEST);
+  shGetViewport(vp);
   dt = SDL_GetTicks();
   gl4duBindMatrix("projectionMatrix");
   gl4duLoadIdentityf();
   gl4duFrustumf(-0.5, 0.5, -0.5 * vp[3] / vp[2], 0.5 * vp[3] / vp[2], 1.0, 1000.0);
+  lhBegin();
   gl4duBindMatrix("modelViewMatrix");
 
   gl4duLoadIdentityf();
@@ -255,22 +304,21 @@ static void draw(void) {
   if(!_scale) glClearColor(0.13f, 0.14f, 0.60f, 0.0f);
   else glClearColor(0.0f, 0.0f, 0.0, 0.0f);
 
+  phSet(_post, _postSwirl, _swirl, phSwirlAngle(0.0005f, _direction, dt));
+  phBegin(_post);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   mat = gl4duGetMatrixData();
-  glDisable(GL_CULL_FACE);
-  glEnable(GL_DEPTH_TEST);
-  glDisable(GL_BLEND);
-  glUseProgram(_pId);
-
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, _tId[_cur_id]);
-  glUniform1i(glGetUniformLocation(_pId, "tex0"), 0);
-  glUniform1i(glGetUniformLocation(_pId, "temps"), dt);
-  glUniform1i(glGetUniformLocation(_pId, "swirl"), _swirl);
-  glUniform1i(glGetUniformLocation(_pId, "direction"), _direction);
+  shDisable(GL_CULL_FACE);
+  shEnable(GL_DEPTH_TEST);
+  shDisable(GL_BLEND);
+  shUseProgram(_pId);
+
+  shActiveTexture(GL_TEXTURE0);
+  shBindTexture(GL_TEXTURE_2D, _tId[_cur_id]);
+  glUniform1i(_u[U_TEX0], 0);
 
   mobileMove();
-  mobile2texture(f);
+  lists = jhRun(_nb_mobiles, MOBILE_GRAIN, mobileJob, f);
   if(!_scale) {
     s[0] = f[2];
     s[1] = f[2];
@@ -283,8 +331,8 @@ static void draw(void) {
     gl4duSendMatrices();
   } gl4duPopMatrix();
   gl4dgDraw(_sphere);
-  glActiveTexture(GL_TEXTURE1);
-  glBindTexture(GL_TEXTURE_2D, 0);
+  shActiveTexture(GL_TEXTURE1);
+  shBindTexture(GL_TEXTURE_2D, 0);
 
   if(!_scale) {
     if(_torusRotate) {
@@ -295,23 +343,25 @@ static void draw(void) {
         gl4duScalef(0.6f, 0.6f, 0.6f);
         gl4duSendMatrices();
       } gl4duPopMatrix();
-      glActiveTexture(GL_TEXTURE0);
-      glBindTexture(GL_TEXTURE_2D, _tId[_cur_id]);      
+      shActiveTexture(GL_TEXTURE0);
+      shBindTexture(GL_TEXTURE_2D, _tId[_cur_id]);      
       gl4dgDraw(_torus);
     }
   }
 
   if(!_scale) {
-    for(i = 1; i < _nb_mobiles; i++) {
-      glActiveTexture(GL_TEXTURE0);
-      glBindTexture(GL_TEXTURE_2D, _tId[_mobile[i].texId]);
-      gl4duPushMatrix(); {
-        gl4duTranslatef((((f[8 * i + 0] * 3) / _w)), (f[8 * i + 1] * 2) / _h, 0);  
-        gl4duScalef(f[8 * i + 2] * 0.2, f[8 * i + 2] * 0.2, f[8 * i + 2] * 0.2);
-        gl4duSendMatrices();
-      } gl4duPopMatrix();
-      gl4dgDraw(_sphere);
-    }
+    /* les mobiles : une instance chacun, dessinés en un appel par
+     * niveau de détail */
+    shUseProgram(_ipId);
+    shActiveTexture(GL_TEXTURE0);
+    shBindTexture(GL_TEXTURE_2D_ARRAY, _taId);
+    glUniform1i(_iu[U_TEX0], 0);
+    for(i = 0; i < lists; i++)
+      for(c = jhList(i, &n), j = 0; j < n; j++, c++)
+        lhAdd(c->t[0], c->t[1], c->t[2], c->t[3], c->color, c->material);
+    gl4duSendMatrices();
+    lhDraw(_iu[U_IMPOSTOR]);
+    shBindTexture(GL_TEXTURE_2D_ARRAY, 0);
   }
 
   a+= 3;
@@ -321,21 +371,35 @@ static void draw(void) {
   }
 
   lf = _basses;
+  phEnd(_post);
   if(!gdt)
-    glDisable(GL_DEPTH_TEST);
+    shDisable(GL_DEPTH_TEST);
 }
 
 static void quit(void) {
+  lhClean();
+  jhClean();
+  phDelete(_post);
+  _post = NULL;
   _nb_mobiles = 0;
   if(_mobile) {
     free(_mobile);
     _mobile = NULL;
   }
 
+  if(_f) {
+    free(_f);
+    _f = NULL;
+  }
+
   if(_tId[0]) {
     glDeleteTextures(NTEXTURES, _tId);
     _tId[0] = 0;
   }
+  if(_taId) {
+    glDeleteTextures(1, &_taId);
+    _taId = 0;
+  }
 
   if(_screen) {
     gl4dpSetScreen(_screen);
@@ -7,6 +7,7 @@
 #include <GL4D/gl4dh.h>
 #include <GL4D/gl4dp.h>
 #include "audioHelper.h"
+#include "stateHelper.h"
 
 
 typedef struct mobile_t mobile_t;
@@ -204,6 +205,7 @@ void growCircle(int state) {
     default:
       draw();
       gl4dpUpdateScreen(NULL);
+      shInvalidate(SH_PROGRAM_BIT | SH_TEXTURE_BIT | SH_ENABLE_BIT);
       return;
   }
 }
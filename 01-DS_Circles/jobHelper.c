@@ -0,0 +1,173 @@
+#include "jobHelper.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <SDL.h>
+
+/*!\brief nombre d'éléments en dessous duquel jhRun travaille sur place :
+ * réveiller un thread du pool puis attendre sa fin coûte environ 5 µs,
+ * le temps de copier quelque 7000 mobiles (0,75 ns par mobile de huit
+ * flottants) ; il faut donc plusieurs fois ce volume pour gagner. */
+#define JH_MIN_ELEMENTS 16384
+
+/*!\brief liste de commandes d'un thread, réutilisée d'un jhRun à
+ * l'autre */
+struct jhList_t {
+  jhCmd_t * cmd;
+  int n, size;
+};
+
+typedef struct jhThread_t jhThread_t;
+struct jhThread_t {
+  SDL_Thread * thread;
+  jhList_t list;
+};
+
+/*!\brief nombre d'effets utilisant le pool */
+static int _users = 0;
+/*!\brief vaut 1 quand les threads de travail sont lancés */
+static int _started = 0;
+/*!\brief pool de threads : _threads[0] est le thread appelant, qui
+ * travaille aussi ; les autres attendent un nouveau numéro de passe,
+ * prennent des tranches d'éléments à un compteur atomique et signalent
+ * leur fin */
+static jhThread_t * _threads = NULL;
+static int _nbThreads = 0, _pass = 0, _finished = 0, _quit = 0;
+static SDL_mutex * _mutex = NULL;
+static SDL_cond * _start = NULL, * _done = NULL;
+static SDL_atomic_t _next;
+/*!\brief job de la passe courante, ses données, son nombre d'éléments
+ * et la taille des tranches */
+static jhJob_t _job = NULL;
+static void * _data = NULL;
+static int _n = 0, _grain = 1;
+
+/*!\brief exécute des tranches du job courant jusqu'à épuisement, dans
+ * la liste du thread \a t. */
+static void work(jhThread_t * t) {
+  int c;
+  t->list.n = 0;
+  while((c = SDL_AtomicAdd(&_next, 1)) < (_n + _grain - 1) / _grain)
+    _job(c * _grain, MIN((c + 1) * _grain, _n), _data, &t->list);
+}
+
+/*!\brief thread de travail : attend chaque passe de jhRun. */
+static int worker(void * data) {
+  jhThread_t * t = data;
+  int pass = 0;
+  for(;;) {
+    SDL_LockMutex(_mutex);
+    while(_pass == pass && !_quit)
+      SDL_CondWait(_start, _mutex);
+    pass = _pass;
+    SDL_UnlockMutex(_mutex);
+    if(_quit)
+      return 0;
+    work(t);
+    SDL_LockMutex(_mutex);
+    if(++_finished == _nbThreads - 1)
+      SDL_CondSignal(_done);
+    SDL_UnlockMutex(_mutex);
+  }
+}
+
+/*!\brief prépare le pool au premier effet qui l'utilise : un thread
+ * par processeur, le thread appelant compris. Les threads de travail ne
+ * sont lancés qu'au premier jhRun assez grand pour eux. */
+void jhInit(void) {
+  if(_users++) return;
+  _nbThreads = MAX(SDL_GetCPUCount(), 1);
+  _threads = calloc(_nbThreads, sizeof *_threads);
+  assert(_threads);
+  _mutex = SDL_CreateMutex();
+  _start = SDL_CreateCond();
+  _done = SDL_CreateCond();
+  _pass = _finished = _quit = _started = 0;
+}
+
+/*!\brief lance les threads de travail. */
+static void start(void) {
+  int i;
+  for(i = 1; i < _nbThreads; i++) {
+    _threads[i].thread = SDL_CreateThread(worker, "jobHelper", &_threads[i]);
+    assert(_threads[i].thread);
+  }
+  _started = 1;
+}
+
+/*!\brief répartit les \a n éléments entre les threads par tranches de
+ * \a grain, chaque tranche étant passée à \a job avec \a data et la
+ * liste du thread qui l'exécute ; rend la main quand tout est traité.
+ * Un job ne doit faire aucun appel OpenGL ni toucher d'état partagé
+ * autre que ses propres éléments. Sous JH_MIN_ELEMENTS éléments (ou
+ * une seule tranche), le travail est fait sur place sans réveiller le
+ * pool.
+ * \return le nombre de listes à relire avec jhList.
+ */
+int jhRun(int n, int grain, jhJob_t job, void * data) {
+  assert(_users);
+  _job = job;
+  _data = data;
+  _n = n;
+  _grain = MAX(grain, 1);
+  SDL_AtomicSet(&_next, 0);
+  if(_nbThreads < 2 || n <= _grain || n < JH_MIN_ELEMENTS) {
+    work(&_threads[0]);
+    return 1;
+  }
+  if(!_started)
+    start();
+  SDL_LockMutex(_mutex);
+  _finished = 0;
+  _pass++;
+  SDL_CondBroadcast(_start);
+  SDL_UnlockMutex(_mutex);
+  work(&_threads[0]);
+  SDL_LockMutex(_mutex);
+  while(_finished < _nbThreads - 1)
+    SDL_CondWait(_done, _mutex);
+  SDL_UnlockMutex(_mutex);
+  return _nbThreads;
+}
+
+/*!\brief ajoute une commande à \a list.
+ * \return la commande, à remplir.
+ */
+jhCmd_t * jhRecord(jhList_t * list) {
+  if(list->n == list->size) {
+    list->size = list->size ? 2 * list->size : 256;
+    list->cmd = realloc(list->cmd, list->size * sizeof *list->cmd);
+    assert(list->cmd);
+  }
+  return &list->cmd[list->n++];
+}
+
+/*!\brief renvoie les commandes enregistrées par le thread \a i lors
+ * du dernier jhRun et leur nombre dans \a n. L'ordre entre listes
+ * dépend de la répartition des tranches. */
+const jhCmd_t * jhList(int i, int * n) {
+  *n = _threads[i].list.n;
+  return _threads[i].list.cmd;
+}
+
+/*!\brief arrête le pool quand plus aucun effet ne l'utilise. */
+void jhClean(void) {
+  int i;
+  if(!_users || --_users) return;
+  SDL_LockMutex(_mutex);
+  _quit = 1;
+  SDL_CondBroadcast(_start);
+  SDL_UnlockMutex(_mutex);
+  for(i = 0; i < _nbThreads; i++) {
+    if(_threads[i].thread)
+      SDL_WaitThread(_threads[i].thread, NULL);
+    free(_threads[i].list.cmd);
+  }
+  free(_threads);
+  _threads = NULL;
+  _nbThreads = 0;
+  SDL_DestroyCond(_start);
+  SDL_DestroyCond(_done);
+  SDL_DestroyMutex(_mutex);
+  _start = _done = NULL;
+  _mutex = NULL;
+}
@@ -0,0 +1,36 @@
+#ifndef _JOB_HELPER_H
+
+#define _JOB_HELPER_H
+
+#include <GL4D/gl4du.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  typedef struct jhCmd_t jhCmd_t;
+  typedef struct jhList_t jhList_t;
+
+  /*!\brief une commande de dessin enregistrée par un job : transformation
+   * (position et rayon), couleur et indice de matériau */
+  struct jhCmd_t {
+    GLfloat t[4];
+    GLfloat color[4];
+    GLint material;
+  };
+
+  /*!\brief un job traite les éléments [\a first, \a last[ et enregistre
+   * ses commandes dans \a list, propre au thread qui l'exécute */
+  typedef void (* jhJob_t)(int first, int last, void * data, jhList_t * list);
+
+  extern void            jhInit(void);
+  extern int             jhRun(int n, int grain, jhJob_t job, void * data);
+  extern jhCmd_t *       jhRecord(jhList_t * list);
+  extern const jhCmd_t * jhList(int i, int * n);
+  extern void            jhClean(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef _LOD_HELPER_H
+
+#define _LOD_HELPER_H
+
+#include <GL4D/gl4du.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  extern void   lhInit(void);
+  extern void   lhBegin(void);
+  extern void   lhAdd(GLfloat x, GLfloat y, GLfloat z, GLfloat r, const GLfloat * color, GLfloat layer);
+  extern int    lhDraw(GLint impostor);
+  extern GLuint lhTexArray(const char ** files, int n, int w, int h);
+  extern void   lhClean(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
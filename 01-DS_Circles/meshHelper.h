@@ -0,0 +1,21 @@
+#ifndef _MESH_HELPER_H
+
+#define _MESH_HELPER_H
+
+#include <GL4D/gl4du.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  extern void     mhOptimize(GLuint * index, int nbIndices, int nbVertices);
+  extern void     mhReorderVertices(GLuint * index, int nbIndices, void * vertices, size_t size, int nbVertices);
+  extern GLfloat  mhACMR(const GLuint * index, int nbIndices, int nbVertices);
+  extern GLuint   mhPackNormal(GLfloat x, GLfloat y, GLfloat z);
+  extern GLushort mhHalf(GLfloat f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -5,6 +5,10 @@
 #include <SDL_mixer.h>
 #include <GL4D/gl4dh.h>
 #include "audioHelper.h"
+#include "normalMapHelper.h"
+#include "lodHelper.h"
+#include "variantHelper.h"
+#include "stateHelper.h"
 
 static void         init(int w, int h);
 static void         draw(void);
@@ -15,8 +19,16 @@ static float        myRand(float max);
 #define NB_TEXTURES 7
 
 static GLuint _pId = 0;
+/*!\brief programme des petites sphères instanciées et leur texture
+ * tableau */
+static GLuint _ipId = 0;
+static GLuint _taId = 0;
+/*!\brief uniforms des deux programmes, relevés à l'initialisation
+ * (basses et aigus viennent du bloc "frame") */
+enum { U_EDAY = 0, U_EBUMP, U_EGLOSS, U_LUMPOS, U_IMPOSTOR, U_NB };
+static const char * const _uNames[U_NB] = { "eday", "ebump", "egloss", "lumPos", "impostor" };
+static GLint _u[U_NB], _iu[U_NB];
 static GLuint _sphere = 0;
-static GLuint _longitudes = 200, _latitudes = 200;
 static GLfloat _lumPos0[4] = {-15.1, 20.0, 20.7, 1.0};
 static GLfloat _basses = 0, _aigus = 0;
 
@@ -36,12 +48,6 @@ static const char * _texture_filenames[] = {
   "images/star04.png",
 };
 
-static const char * _sampler_names[] = {
-  "eday", 
-  "ebump", 
-  "egloss" 
-};
-
 enum texture_e {
   TE_STAR00 = 0,  /* star00.png */
   TE_EBUMP,       /* star00_bump.png */
@@ -74,12 +80,17 @@ static void init(int w, int h) {
     glGenTextures(NB_TEXTURES, _tId);
     for(i = 0; i < NB_TEXTURES; i++) {
       SDL_Surface * t;
-      glBindTexture(GL_TEXTURE_2D, _tId[i]);
+      shBindTexture(GL_TEXTURE_2D, _tId[i]);
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
       if( (t = IMG_Load(_texture_filenames[i])) != NULL ) {
   int mode = t->format->BytesPerPixel == 4 ? GL_RGBA : GL_RGB;    
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, t->w, t->h, 0, mode, GL_UNSIGNED_BYTE, t->pixels);
+  /* le relief devient une carte de normales, à l'échelle du Sobel
+   * que faisait full.fs avec un pas d'un pixel écran */
+  if(i == TE_EBUMP)
+    nmTexImage(t, 0.75f * t->w / _w, 0.75f * t->h / _h);
+  else
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, t->w, t->h, 0, mode, GL_UNSIGNED_BYTE, t->pixels);
   SDL_FreeSurface(t);
       } else {
   fprintf(stderr, "can't open file %s : %s\n", _texture_filenames[i], SDL_GetError());
@@ -87,13 +98,19 @@ static void init(int w, int h) {
       }
     }
   }
+  /* couches 0 à 3 : star01 à star04, en taille réduite */
+  if(!_taId)
+    _taId = lhTexArray(&_texture_filenames[TE_END], NB_STAR, 512, 256);
 
   glClearColor(0.13f, 0.14f, 0.60f, 0.0f);
-  _pId  = gl4duCreateProgram("<vs>shaders/full.vs", "<fs>shaders/full.fs", NULL);
+  _pId  = vhProgram("shaders/full.vs", "shaders/full.fs", NULL);
+  _ipId = vhProgram("shaders/full.vs", "shaders/full.fs", "#define INSTANCED\n");
+  vhUniforms(_pId, _uNames, U_NB, _u);
+  vhUniforms(_ipId, _uNames, U_NB, _iu);
   gl4duGenMatrix(GL_FLOAT, "modelViewMatrix");
   gl4duGenMatrix(GL_FLOAT, "projectionMatrix");
-  _sphere = gl4dgGenSpheref(_longitudes, _latitudes);
   _sphere = gl4dgGenSpheref(30, 30);
+  lhInit();
 
   _nb_spheres = 200;
   _sph_att = malloc(_nb_spheres * 2 * sizeof(*_sph_att));
@@ -109,72 +126,79 @@ static void draw(void) {
   static GLfloat a0 = 0.0;
   static Uint32 t0 = 0;
   GLint vp[4];
-  GLfloat dt = 0.0, steps[2] = {1.0f / _w, 1.0f / _h};
+  GLfloat dt = 0.0;
   GLfloat lumPos[4], *mat;
   Uint32 t;
   dt = ((t = SDL_GetTicks()) - t0) / 1000.0;
   t0 = t;
 
-  GLboolean gdt = glIsEnabled(GL_DEPTH_TEST);
-  glGetIntegerv(GL_VIEWPORT, vp);
+  GLboolean gdt = shIsEnabled(GL_DEPTH_TEST);
+  shGetViewport(vp);
   gl4duBindMatrix("projectionMatrix");
   gl4duLoadIdentityf();
   gl4duFrustumf(-0.5, 0.5, -0.5 * vp[3] / vp[2], 0.5 * vp[3] / vp[2], 1.0, 1000.0);
+  lhBegin();
   gl4duBindMatrix("modelViewMatrix");
   
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  glDisable(GL_CULL_FACE);
-  glEnable(GL_DEPTH_TEST);
-  glDisable(GL_BLEND);
+  shDisable(GL_CULL_FACE);
+  shEnable(GL_DEPTH_TEST);
+  shDisable(GL_BLEND);
   gl4duBindMatrix("modelViewMatrix");
   gl4duLoadIdentityf();
   gl4duTranslatef(0, 0, -3);
   mat = gl4duGetMatrixData();
   MMAT4XVEC4(lumPos, mat, _lumPos0);
 
-  glUseProgram(_pId);
+  /* les petites sphères : une instance chacune, dessinées en un appel
+   * par niveau de détail */
+  shUseProgram(_ipId);
+  shActiveTexture(GL_TEXTURE0);
+  shBindTexture(GL_TEXTURE_2D_ARRAY, _taId);
+  for(i = 0; i < TE_END; i++)
+    glUniform1i(_iu[U_EDAY + i], i);
+  glUniform4fv(_iu[U_LUMPOS], 1, lumPos);
   for(i = 0; i < _nb_spheres; i++) {
-    int id = (gl4dmURand() * 4.0) + 3.0;
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _tId[id]);
-    gl4duPushMatrix(); { 
-      gl4duTranslatef(_sph_att[i * 2 + 0], _sph_att[i * 2 + 1], 0);  
-      GLfloat sc = gl4dmURand() * 0.015;
-      gl4duScalef(sc, sc, sc);
-      gl4duSendMatrices();
-    } gl4duPopMatrix();
-    gl4dgDraw(_sphere);
+    int layer = gl4dmURand() * NB_STAR;
+    lhAdd(_sph_att[i * 2 + 0], _sph_att[i * 2 + 1], 0, gl4dmURand() * 0.015, NULL, layer);
   }
+  gl4duSendMatrices();
+  lhDraw(_iu[U_IMPOSTOR]);
+  shBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+  shUseProgram(_pId);
 
   for(i = 0; i < TE_END; i++) {
-    glActiveTexture(GL_TEXTURE0 + i);
-    glBindTexture(GL_TEXTURE_2D, _tId[i]);
+    shActiveTexture(GL_TEXTURE0 + i);
+    shBindTexture(GL_TEXTURE_2D, _tId[i]);
     gl4duRotatef(a0, 0, 1, 0);
     gl4duScalef(0.75, 0.75, 0.75);
-    glUniform1i(glGetUniformLocation(_pId, _sampler_names[i]), i);
+    glUniform1i(_u[U_EDAY + i], i);
   }
-  glUniform1f(glGetUniformLocation(_pId, "basses"), _basses);
-  glUniform1f(glGetUniformLocation(_pId, "aigus"), _aigus);
-  glUniform2fv(glGetUniformLocation(_pId, "steps"), 1, steps);
-  glUniform4fv(glGetUniformLocation(_pId, "lumPos"), 1, lumPos);
+  glUniform4fv(_u[U_LUMPOS], 1, lumPos);
   gl4duSendMatrices();
   gl4dgDraw(_sphere);
   
   for(i = 0; i < TE_END; i++) {
-    glActiveTexture(GL_TEXTURE0 + TE_END - 1 - i);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    shActiveTexture(GL_TEXTURE0 + TE_END - 1 - i);
+    shBindTexture(GL_TEXTURE_2D, 0);
   }
 
   a0 += 360.0 * dt / 24.0;
   if(!gdt)
-    glDisable(GL_DEPTH_TEST);
+    shDisable(GL_DEPTH_TEST);
 }
 
 static void quit(void) {
+  lhClean();
   if(_tId[0]) {
     glDeleteTextures(NB_TEXTURES, _tId);
     _tId[0] = 0;
   }
+  if(_taId) {
+    glDeleteTextures(1, &_taId);
+    _taId = 0;
+  }
 
   if(_screen) {
     gl4dpSetScreen(_screen);
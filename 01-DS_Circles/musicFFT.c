@@ -9,11 +9,12 @@
 #include <fftw3.h>
 #include <GL4D/gl4dh.h>
 #include "audioHelper.h"
+#include "drawHelper.h"
+#include "stateHelper.h"
 
 static void init(int w, int h);
 static void audio(void);
 static void draw(void);
-static void drawPixelWithThickness(int x, int y, int t);
 static void quit(void);
 
 #define ECHANTILLONS 1024
@@ -46,15 +47,6 @@ static void init(int w, int h) {
   assert(_plan4fftw);
 }
 
-static void drawPixelWithThickness(int x, int y, int t) {
-  int i;
-  for(i = 0; i < t; i++) {
-    gl4dpPutPixel(x+i, y+i);
-    gl4dpPutPixel(x, y);
-    gl4dpPutPixel(x-i, y-i);
-  }
-}
-
 static void draw(void) {
   int i;
   int nc = 6;
@@ -66,10 +58,11 @@ static void draw(void) {
     gl4dpSetColor(RGB(_color[cur_color][0], _color[cur_color][1], _color[cur_color][2]));
     x0 = (i * (_w - 1)) / (ECHANTILLONS - 1);
     y0 = _hauteurs[i];
-    drawPixelWithThickness(x0 + _w/2.7, y0 + _h/2.7, 3);
+    dhPoint(x0 + _w/2.7, y0 + _h/2.7, 3);
     cur_color = (cur_color + 1) % nc;
   }
   gl4dpUpdateScreen(NULL);
+  shInvalidate(SH_PROGRAM_BIT | SH_TEXTURE_BIT | SH_ENABLE_BIT);
 }
 
 static void audio(void) {
@@ -0,0 +1,228 @@
+#include "postHelper.h"
+#include "variantHelper.h"
+#include "stateHelper.h"
+#include <GL4D/gl4dg.h>
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+/*!\brief nombre maximal de passes d'une chaîne */
+#define PH_MAX_PASSES 8
+
+/*!\brief une passe : son type, sa résolution (fraction de celle de la
+ * vue), son paramètre et son état */
+typedef struct phPass_t phPass_t;
+struct phPass_t {
+  int type, enabled;
+  GLfloat scale, param;
+};
+
+/*!\brief chaîne de passes appliquées dans l'ordre. La scène est
+ * dessinée dans \a scene (avec un tampon de profondeur) puis chaque
+ * passe lit la région écrite par la précédente et écrit dans l'autre
+ * texture du ping-pong \a tex. */
+struct phChain_t {
+  phPass_t pass[PH_MAX_PASSES];
+  int nbPasses, active, w, h;
+  GLuint fbo, scene, depth, tex[2];
+  /*!\brief cible (framebuffer et viewport) à restaurer */
+  GLint target, vp[4];
+};
+
+/*!\brief programmes de chaque type de passe et de la copie finale,
+ * compilés une fois pour toutes les chaînes */
+static GLuint _pId[PH_NB_TYPES] = { 0 }, _copyId = 0, _quad = 0;
+/*!\brief emplacements des uniforms de ces programmes, relevés une fois
+ * compilés */
+enum { U_TEX = 0, U_INSCALE, U_PARAM, U_DIR, U_NB };
+static const char * const _uNames[U_NB] = { "tex", "inScale", "param", "dir" };
+static GLint _u[PH_NB_TYPES][U_NB], _copyU[U_NB];
+
+/*!\brief crée une chaîne vide ; compile les passes au premier appel. */
+phChain_t * phNew(void) {
+  int i;
+  phChain_t * c = calloc(1, sizeof *c);
+  assert(c);
+  if(!_copyId) {
+    _pId[PH_SWIRL]    = vhProgram("shaders/post.vs", "shaders/postSwirl.fs", NULL);
+    _pId[PH_FADE]     = vhProgram("shaders/post.vs", "shaders/postFade.fs", NULL);
+    _pId[PH_BLUR]     = vhProgram("shaders/post.vs", "shaders/postBlur.fs", NULL);
+    _copyId           = vhProgram("shaders/post.vs", "shaders/postCopy.fs", NULL);
+    /* la pixellisation n'est qu'une copie à basse résolution */
+    _pId[PH_PIXELATE] = _copyId;
+    for(i = 0; i < PH_NB_TYPES; i++)
+      vhUniforms(_pId[i], _uNames, U_NB, _u[i]);
+    vhUniforms(_copyId, _uNames, U_NB, _copyU);
+    _quad = gl4dgGenQuadf();
+  }
+  return c;
+}
+
+/*!\brief ajoute à la fin de \a c une passe de type \a type, calculée à
+ * la résolution de la vue multipliée par \a scale (ignoré pour
+ * PH_PIXELATE dont la résolution suit la taille des pixels). La passe
+ * est désactivée.
+ * \return l'indice de la passe.
+ */
+int phAdd(phChain_t * c, int type, GLfloat scale) {
+  phPass_t * p;
+  assert(c->nbPasses < PH_MAX_PASSES && type >= 0 && type < PH_NB_TYPES);
+  p = &c->pass[c->nbPasses];
+  p->type = type;
+  p->scale = scale;
+  p->enabled = 0;
+  p->param = 0.0f;
+  return c->nbPasses++;
+}
+
+/*!\brief active ou désactive la passe \a pass et fixe son
+ * paramètre. */
+void phSet(phChain_t * c, int pass, int enabled, GLfloat param) {
+  phPass_t * p = &c->pass[pass];
+  p->enabled = enabled;
+  p->param = param;
+  if(p->type == PH_PIXELATE)
+    p->scale = 1.0f / MAX(param, 1.0f);
+}
+
+/*!\brief renvoie le paramètre de PH_SWIRL équivalent à un tourbillon
+ * en espace texture des anciens shaders (angle += \a rate * \a ms / (1
+ * + distance), autour du point \a center * (0.5, 0.5)) : l'angle qu'il
+ * donnait au centre de la texture, du signe de \a center. */
+GLfloat phSwirlAngle(GLfloat rate, GLfloat center, GLfloat ms) {
+  GLfloat d = fabsf(1.0f - center) * 0.70710678f;
+  return (center < 0.0f ? -rate : rate) * ms / (1.0f + d);
+}
+
+/*!\brief (ré)alloue les textures de \a c pour une vue de \a w x \a h. */
+static void resize(phChain_t * c, int w, int h) {
+  int i;
+  GLuint t[3];
+  if(c->fbo && c->w == w && c->h == h)
+    return;
+  if(!c->fbo) {
+    glGenFramebuffers(1, &c->fbo);
+    glGenRenderbuffers(1, &c->depth);
+    glGenTextures(3, t);
+    c->scene = t[0]; c->tex[0] = t[1]; c->tex[1] = t[2];
+  }
+  c->w = w; c->h = h;
+  for(i = 0; i < 3; i++) {
+    shBindTexture(GL_TEXTURE_2D, i ? c->tex[i - 1] : c->scene);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+  }
+  shBindTexture(GL_TEXTURE_2D, 0);
+  glBindRenderbuffer(GL_RENDERBUFFER, c->depth);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+}
+
+/*!\brief redirige le dessin vers la chaîne si au moins une passe est
+ * active ; sinon ne fait rien et la scène est dessinée directement
+ * dans la cible. */
+void phBegin(phChain_t * c) {
+  int i;
+  c->active = 0;
+  for(i = 0; i < c->nbPasses; i++)
+    c->active |= c->pass[i].enabled;
+  if(!c->active)
+    return;
+  c->target = shFramebuffer(GL_DRAW_FRAMEBUFFER);
+  shGetViewport(c->vp);
+  resize(c, c->vp[2], c->vp[3]);
+  shBindFramebuffer(GL_FRAMEBUFFER, c->fbo);
+  shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, c->scene, 0);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, c->depth);
+  shViewport(0, 0, c->w, c->h);
+}
+
+/*!\brief dessine le quadrilatère avec le programme \a pId (et ses
+ * uniforms \a u) en lisant la région \a sw x \a sh de \a src
+ * (filtrage au plus proche si \a nearest) ; écrit dans \a dst, ou dans
+ * la cible si \a dst est nul. */
+static void step(phChain_t * c, GLuint pId, const GLint * u, GLuint src, int sw, int sh, int nearest,
+		 GLuint dst, int dw, int dh, GLfloat param, const GLfloat * dir) {
+  if(dst) {
+    shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dst, 0);
+    shViewport(0, 0, dw, dh);
+  } else {
+    shBindFramebuffer(GL_FRAMEBUFFER, c->target);
+    shViewport(c->vp[0], c->vp[1], c->vp[2], c->vp[3]);
+  }
+  shUseProgram(pId);
+  shActiveTexture(GL_TEXTURE0);
+  shBindTexture(GL_TEXTURE_2D, src);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, nearest ? GL_NEAREST : GL_LINEAR);
+  glUniform1i(u[U_TEX], 0);
+  glUniform2f(u[U_INSCALE], sw / (GLfloat)c->w, sh / (GLfloat)c->h);
+  glUniform1f(u[U_PARAM], param);
+  if(dir)
+    glUniform2f(u[U_DIR], dir[0] / c->w, dir[1] / c->h);
+  gl4dgDraw(_quad);
+}
+
+/*!\brief applique les passes actives à la scène dessinée depuis
+ * phBegin et écrit le résultat dans la cible. Une dernière passe à
+ * pleine résolution écrit directement dans la cible, sinon une copie
+ * remet le résultat à l'échelle. */
+void phEnd(phChain_t * c) {
+  int i, last = -1, cur = 0, sw = c->w, sh = c->h, nearest = 0;
+  GLenum pm;
+  GLuint src = c->scene;
+  GLboolean dt, bl;
+  if(!c->active)
+    return;
+  for(i = 0; i < c->nbPasses; i++)
+    if(c->pass[i].enabled) last = i;
+  dt = shIsEnabled(GL_DEPTH_TEST);
+  bl = shIsEnabled(GL_BLEND);
+  pm = shGetPolygonMode();
+  shDisable(GL_DEPTH_TEST);
+  shDisable(GL_BLEND);
+  shPolygonMode(GL_FILL);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, 0);
+  for(i = 0; i <= last; i++) {
+    const phPass_t * p = &c->pass[i];
+    int dw = MAX((int)ceilf(c->w * p->scale), 1), dh = MAX((int)ceilf(c->h * p->scale), 1);
+    int toTarget = i == last && dw == c->w && dh == c->h;
+    if(!p->enabled) continue;
+    if(p->type == PH_BLUR) {
+      GLfloat hdir[2] = { p->param, 0.0f }, vdir[2] = { 0.0f, p->param };
+      step(c, _pId[PH_BLUR], _u[PH_BLUR], src, sw, sh, nearest, c->tex[cur], dw, dh, p->param, hdir);
+      src = c->tex[cur]; cur ^= 1; sw = dw; sh = dh; nearest = 0;
+      step(c, _pId[PH_BLUR], _u[PH_BLUR], src, sw, sh, 0, toTarget ? 0 : c->tex[cur], dw, dh, p->param, vdir);
+    } else
+      step(c, _pId[p->type], _u[p->type], src, sw, sh, nearest, toTarget ? 0 : c->tex[cur], dw, dh, p->param, NULL);
+    if(toTarget)
+      break;
+    src = c->tex[cur]; cur ^= 1; sw = dw; sh = dh;
+    nearest = p->type == PH_PIXELATE;
+  }
+  if(i > last)
+    step(c, _copyId, _copyU, src, sw, sh, nearest, 0, 0, 0, 0.0f, NULL);
+  shBindFramebuffer(GL_FRAMEBUFFER, c->target);
+  shViewport(c->vp[0], c->vp[1], c->vp[2], c->vp[3]);
+  shBindTexture(GL_TEXTURE_2D, 0);
+  shUseProgram(0);
+  if(dt)
+    shEnable(GL_DEPTH_TEST);
+  if(bl)
+    shEnable(GL_BLEND);
+  shPolygonMode(pm);
+}
+
+/*!\brief libère la chaîne \a c (les programmes restent pour les
+ * autres chaînes). */
+void phDelete(phChain_t * c) {
+  if(!c) return;
+  if(c->fbo) {
+    GLuint t[3] = { c->scene, c->tex[0], c->tex[1] };
+    glDeleteTextures(3, t);
+    glDeleteRenderbuffers(1, &c->depth);
+    glDeleteFramebuffers(1, &c->fbo);
+  }
+  free(c);
+}
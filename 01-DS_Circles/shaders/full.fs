@@ -1,29 +1,28 @@
 #version 330
 uniform vec4 lumPos;
-uniform vec2 steps;
-uniform sampler2D eday, egloss, ebump;
-uniform float basses, aigus;
+uniform int impostor;
+uniform sampler2D egloss, ebump;
+#ifdef INSTANCED
+/* une couche de texture et une couleur par instance */
+uniform sampler2DArray eday;
+flat in vec4 vsoColor;
+flat in float vsoLayer;
+#else
+uniform sampler2D eday;
+#endif
+/* valeurs communes de la frame (voir vhFrame) */
+layout (std140) uniform frame {
+  vec4  frResolution;
+  float frTime, frBasses, frAigus;
+};
 in  vec3 vsoNormal;
 in  vec3 vsoModPos;
 in  vec2 vsoTexCoord;
 out vec4 fragColor;
 
-vec2 G[9] = vec2[9](vec2(-1, -1), vec2(0, -2), vec2(1, -1),
-		    vec2(-2,  0), vec2(0,  0), vec2(2, 0),
-		    vec2(-1,  1), vec2(0,  2), vec2(1,  1));
-
-vec2 offset[9] = vec2[9](vec2(-steps.x,  steps.y), vec2(0,  steps.y), vec2(steps.x,  steps.y),
-			 vec2(-steps.x,  0),       vec2(0,  0),       vec2(steps.x, 0),
-			 vec2(-steps.x, -steps.y), vec2(0, -steps.y), vec2(steps.x, -steps.y));
-
-vec2 sobel(sampler2D map) {
-  vec2 g = vec2(0);
-  for(int i = 0; i < 9; i++)
-    g += G[i] * texture(map, vsoTexCoord + offset[i]).r;
-  return g;
-}
-
 void main(void) {
+  if(impostor != 0 && length(2.0 * vsoTexCoord - 1.0) > 1.0)
+    discard;
   const vec4 lum_diffus = vec4(1, 1, 0.9, 1);
   const vec4 lum_amb = vec4(0.8, 0.8, 1, 1);
   const vec4 lum_spec = vec4(1, 1, 0.75, 1);
@@ -35,12 +34,16 @@ void main(void) {
   vec3 N = normalize(vsoNormal);
   vec3 B = cross(normalize(vec3(N.x, 0, N.z)), vec3(0, 1, 0));
   vec3 T = cross(N, B);
-  vec2 v = 0.75 * sobel(ebump);
-  N = normalize(N + v.x * B + v.y * T);
+  vec3 n = texture(ebump, vsoTexCoord).xyz * 2.0 - 1.0;
+  N = normalize(n.x * B + n.y * T + n.z * N);
   Idiffuse = clamp(dot(N, -L), 0, 1);
   vec3 V = vec3(0, 0, -1);
   vec3 R = reflect(L, N);
-  Ispec = aigus * (0.3 + 0.7 * texture(egloss, vsoTexCoord).r) * pow(clamp(dot(R, -V), 0, 1), 10);
+  Ispec = frAigus * (0.3 + 0.7 * texture(egloss, vsoTexCoord).r) * pow(clamp(dot(R, -V), 0, 1), 10);
+#ifdef INSTANCED
+  color = vsoColor * texture(eday, vec3(vsoTexCoord, vsoLayer));
+#else
   color = texture(eday, vsoTexCoord);
+#endif
   fragColor = lum_diffus * color * Idiffuse + lum_amb * Iamb * color + lum_spec * Ispec;
 }
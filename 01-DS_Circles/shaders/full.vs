@@ -2,8 +2,13 @@
 
 uniform mat4 modelViewMatrix;
 uniform mat4 projectionMatrix;
+uniform int impostor;
 uniform sampler2D ebump;
-uniform float basses, aigus;
+/* valeurs communes de la frame (voir vhFrame) */
+layout (std140) uniform frame {
+  vec4  frResolution;
+  float frTime, frBasses, frAigus;
+};
 layout (location = 0) in vec3 vsiPosition;
 layout (location = 1) in vec3 vsiNormal;
 layout (location = 2) in vec2 vsiTexCoord;
@@ -12,11 +17,34 @@ out vec3 vsoNormal;
 out vec3 vsoModPos;
 out vec2 vsoTexCoord;
 
+#ifdef INSTANCED
+layout (location = 3) in vec4 vsiInstance;
+layout (location = 4) in vec4 vsiColor;
+layout (location = 5) in float vsiLayer;
+flat out vec4 vsoColor;
+flat out float vsoLayer;
+#endif
+
 void main(void) {
+#ifdef INSTANCED
+  /* centre et rayon de l'instance, dans le repère de modelViewMatrix */
+  vec3 c = vsiInstance.xyz;
+  float r = vsiInstance.w;
+  vsoColor = vsiColor;
+  vsoLayer = vsiLayer;
+#else
+  vec3 c = vec3(0);
+  float r = 1.0;
+#endif
   vsoTexCoord = vec2(vsiTexCoord.x, 1.0 - vsiTexCoord.y);
-  vec3 bpos = vsiPosition + basses * 0.04 * texture(ebump, vsoTexCoord).r * vsiNormal;
-  vec4 mp = modelViewMatrix * vec4(bpos, 1.0);
+  vec3 bpos = vsiPosition + frBasses * 0.04 * texture(ebump, vsoTexCoord).a * vsiNormal;
+  vec4 mp = modelViewMatrix * vec4(c + r * bpos, 1.0);
   vsoNormal = (transpose(inverse(modelViewMatrix))  * vec4(vsiNormal, 0.0)).xyz;
+  /* imposteur : quadrilatère face à la caméra, du rayon de la sphère */
+  if(impostor != 0) {
+    mp = modelViewMatrix * vec4(c, 1) + vec4(r * length(modelViewMatrix[0].xyz) * vsiPosition.xy, 0, 0);
+    vsoNormal = vec3(0, 0, 1);
+  }
   vsoModPos = mp.xyz;
   gl_Position = projectionMatrix * mp;
 }
@@ -2,8 +2,20 @@
 uniform mat4 modelViewMatrix;
 uniform int disco;
 uniform float gap;
-uniform int temps;
+/* valeurs communes de la frame (voir vhFrame) */
+layout (std140) uniform frame {
+  vec4  frResolution;
+  float frTime, frBasses, frAigus;
+};
+uniform int impostor;
+#ifdef INSTANCED
+/* une couche de texture et une couleur par instance */
+uniform sampler2DArray tex0;
+flat in vec4 vsoColor;
+flat in float vsoLayer;
+#else
 uniform sampler2D tex0;
+#endif
 in  vec3 vsoNormal;
 in  vec2 vsoTexCoord;
 in  vec3 vsoModPos;
@@ -12,12 +24,18 @@ out vec4 fragColor;
 #define PI 3.14159265359
 
 void main(void) {
+  if(impostor != 0 && length(2.0 * vsoTexCoord - 1.0) > 1.0)
+    discard;
   float diffuse = 0, spec = 0;
+#ifdef INSTANCED
+  vec4 color = vsoColor * texture(tex0, vec3(vsoTexCoord, vsoLayer));
+#else
   vec4 color = texture(tex0, vsoTexCoord);
+#endif
   vec2 pos = abs(2.0 * (vsoTexCoord.xy) - vec2(1));
   float a = atan(pos.x/2, pos.y/2);
   float r = dot(pos/2, pos/2) * .8;
-  vec4 c = vec4(sin(PI * mod(0.2 * temps/100 + r * 1.0 / 0.3 + gap, 0.8)), 1.0, 1.0, 1.0);
+  vec4 c = vec4(sin(PI * mod(0.2 * frTime/100 + r * 1.0 / 0.3 + gap, 0.8)), 1.0, 1.0, 1.0);
 
   vec4 t = mix(c, color, smoothstep(0.05, .7, r));
 	fragColor = t * color;
@@ -2,6 +2,7 @@
 
 uniform mat4 modelViewMatrix;
 uniform mat4 projectionMatrix;
+uniform int impostor;
 layout (location = 0) in vec3 vsiPosition;
 layout (location = 1) in vec3 vsiNormal;
 layout (location = 2) in vec2 vsiTexCoord;
@@ -11,9 +12,32 @@ out vec3 vsoPosition;
 out vec3 vsoModPos;
 out vec2 vsoTexCoord;
 
+#ifdef INSTANCED
+layout (location = 3) in vec4 vsiInstance;
+layout (location = 4) in vec4 vsiColor;
+layout (location = 5) in float vsiLayer;
+flat out vec4 vsoColor;
+flat out float vsoLayer;
+#endif
+
 void main(void) {
-  vec4 mp = modelViewMatrix * vec4(vsiPosition, 1.0);
+#ifdef INSTANCED
+  /* centre et rayon de l'instance, dans le repère de modelViewMatrix */
+  vec3 c = vsiInstance.xyz;
+  float r = vsiInstance.w;
+  vsoColor = vsiColor;
+  vsoLayer = vsiLayer;
+#else
+  vec3 c = vec3(0);
+  float r = 1.0;
+#endif
+  vec4 mp = modelViewMatrix * vec4(c + r * vsiPosition, 1.0);
   vsoNormal = (transpose(inverse(modelViewMatrix))  * vec4(vsiNormal, 0.0)).xyz;
+  /* imposteur : quadrilatère face à la caméra, du rayon de la sphère */
+  if(impostor != 0) {
+    mp = modelViewMatrix * vec4(c, 1) + vec4(r * length(modelViewMatrix[0].xyz) * vsiPosition.xy, 0, 0);
+    vsoNormal = vec3(0, 0, 1);
+  }
   vsoPosition = vsoPosition;
   vsoModPos   = mp.xyz;
   vsoTexCoord = vec2(vsiTexCoord.x, 1.0 - vsiTexCoord.y);
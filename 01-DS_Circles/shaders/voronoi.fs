@@ -1,42 +1,41 @@
 #version 330
-uniform sampler1D mobiles;
-uniform float step;
-uniform int voronoi;
+uniform samplerBuffer mobiles;
+uniform isampler2D ids;
+uniform int nballs;
 in  vec2 vsoTexCoord;
 out vec4 fragColor;
 
+#ifndef VORONOI
 vec4 balle(void) {
-  float i;
-  for(i = step / 2.0; i < 1.0; i += 2.0 * step) {
-    vec3 po = texture(mobiles, i + step).xyz;
+  for(int i = 0; i < nballs; i++) {
+    vec3 po = texelFetch(mobiles, 2 * i + 1).xyz;
     float d = length(vsoTexCoord - po.xy) - po.z;
     if(d < 0)
-      return texture(mobiles, i);
+      return texelFetch(mobiles, 2 * i);
   }
   return vec4(1);
 }
-
-
+#else
+/* les deux sites les plus proches sont donnés par le jump flooding */
 vec4 voronoif_ombre(void) {
-  float mini = step / 2.0;
-  vec3  po = texture(mobiles, step + mini).xyz;
-  float mind = length(vsoTexCoord - po.xy), old_mind = 1, ombre;
-  for(float i = mini + 2.0 * step; i < 1.0; i += 2.0 * step) {
-    po = texture(mobiles, i + step).xyz;
-    float d = length(vsoTexCoord - po.xy);
-    if(mind > d) {
-      old_mind = mind;
-      mind = d;
-      mini = i;
-    }
-  }
+  ivec2 size = textureSize(ids, 0);
+  ivec2 id = texelFetch(ids, clamp(ivec2(vsoTexCoord * size), ivec2(0), size - 1), 0).xy;
+  float mind, old_mind = 1, ombre;
+  if(id.x < 0)
+    return vec4(0);
+  mind = length(vsoTexCoord - texelFetch(mobiles, 2 * id.x + 1).xy);
+  if(id.y >= 0)
+    old_mind = length(vsoTexCoord - texelFetch(mobiles, 2 * id.y + 1).xy);
   ombre = pow(((old_mind - mind) / old_mind), 0.5);
   if(ombre < 0.4) ombre = 0;
-  return  ombre * texture(mobiles, mini);
-} 
+  return  ombre * texelFetch(mobiles, 2 * id.x);
+}
+#endif
+
 void main(void) {
-  if(voronoi == 1)
-    fragColor = voronoif_ombre();
-  else
-    fragColor = balle();
+#ifdef VORONOI
+  fragColor = voronoif_ombre();
+#else
+  fragColor = balle();
+#endif
 }
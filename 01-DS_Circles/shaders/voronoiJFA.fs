@@ -0,0 +1,36 @@
+#version 330
+uniform samplerBuffer mobiles;
+uniform isampler2D ids;
+uniform vec2 dim;
+uniform int k;
+out ivec2 fragId;
+
+/* une passe de jump flooding : garde, parmi les sites connus des
+ * voisins situés à k pixels, les deux plus proches du fragment */
+void main(void) {
+  ivec2 c = ivec2(gl_FragCoord.xy), size = textureSize(ids, 0);
+  vec2 p = gl_FragCoord.xy / dim;
+  int b0 = -1, b1 = -1;
+  float d0 = 1e9, d1 = 1e9;
+  for(int y = -1; y <= 1; y++) {
+    for(int x = -1; x <= 1; x++) {
+      ivec2 q = c + k * ivec2(x, y);
+      if(any(lessThan(q, ivec2(0))) || any(greaterThanEqual(q, size)))
+        continue;
+      ivec2 cand = texelFetch(ids, q, 0).xy;
+      for(int j = 0; j < 2; j++) {
+        int id = cand[j];
+        if(id < 0 || id == b0 || id == b1)
+          continue;
+        float d = length(p - texelFetch(mobiles, 2 * id + 1).xy);
+        if(d < d0) {
+          b1 = b0; d1 = d0;
+          b0 = id; d0 = d;
+        } else if(d < d1) {
+          b1 = id; d1 = d;
+        }
+      }
+    }
+  }
+  fragId = ivec2(b0, b1);
+}
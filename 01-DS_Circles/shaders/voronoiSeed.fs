@@ -0,0 +1,7 @@
+#version 330
+flat in int vsoId;
+out ivec2 fragId;
+
+void main(void) {
+  fragId = ivec2(vsoId, -1);
+}
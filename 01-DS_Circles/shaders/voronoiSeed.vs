@@ -0,0 +1,11 @@
+#version 330
+uniform samplerBuffer mobiles;
+uniform vec2 dim;
+flat out int vsoId;
+
+void main(void) {
+  /* un point par site, ramené dans l'écran pour ne pas être écrêté */
+  vec2 p = clamp(texelFetch(mobiles, 2 * gl_VertexID + 1).xy, 0.5 / dim, 1.0 - 0.5 / dim);
+  vsoId = gl_VertexID;
+  gl_Position = vec4(2.0 * p - 1.0, 0.0, 1.0);
+}
@@ -7,6 +7,9 @@
 #include <GL4D/gl4dh.h>
 #include <GL4D/gl4dp.h>
 #include "audioHelper.h"
+#include "drawHelper.h"
+#include "starfield.h"
+#include "stateHelper.h"
 
 
 typedef struct mobile_t mobile_t;
@@ -27,25 +30,16 @@ struct triangle {
   point a, b, c;
 };
 
-typedef struct line line;
-
-struct line {
-  float x, y, z, pz;
-  GLuint c;
-};
-
-static float  myRand(float max);
 static void   quit(void);
 static void   init(int w, int h);
 static void   lineMove(void);
-static void   drawLineWithThickness(int x0, int y0, int x1, int y1, int t);
 static void   lineDraw(void);
 static void   triangleMove(void);
 static void   triangleDraw(void);
 static void   draw(void);
 
 enum {
-  FREQ_MOY = 5, FREQ_H = 12
+  FREQ_MOY = 5, FREQ_H = 12, TRIANGLE_THICKNESS = 9
 };
 
 // Variables globales concernant la fenêtre
@@ -56,8 +50,8 @@ static GLuint _screenColor = RGB(0, 0, 0);
 static float _basses = 0;
 
 // Variables globales concernant la première démo : space
-static line * _line = NULL;
-static int _nb_lines = 300;
+static int _nb_lines = 1000000;
+static int _nb_spiral = 300;
 static float _speed = 0.0;
 static float _lspeed = .2;
 static float _angle = 0.0;
@@ -70,39 +64,16 @@ static triangle _triangle;
 static mobile_t _mobile[2];
 static int _nb_mobiles = 2;
 
-static float myRand(float max) {
-  float rand = gl4dmURand() * max;
-  float sgn = gl4dmURand() * 2.0;
-  sgn = sgn > 1.0 ? 1.0 : -1.0;
-  rand *= sgn;
-  return rand;
-}
-
 static void init(int w, int h) {
   int i;
   _w = w; _h = h;
 
-  if(_line) {
-    free(_line);
-    _line = NULL;
-  }
-
   if(!_hasInit) {
     atexit(quit);
     _hasInit = 1;
   }
 
-  _line = malloc(_nb_lines * sizeof * _line);
-  assert(_line);
-  for(i = 0; i < _nb_lines; i++) {
-    GLubyte r, g, b;
-    _line[i].x = myRand(_w);
-    _line[i].y = myRand(_h);
-    _line[i].z = gl4dmURand() * _w;
-    _line[i].pz = _line[i].z;
-    r = rand()&0xFF; g = rand()&0xFF; b = rand()&0xFF;
-    _line[i].c = RGB(r, g, b);
-  }
+  sfInit(_nb_lines, _w, _h);
 
   _triangle.a.x = _w/2 - 1; _triangle.a.y = _h/2;
   _triangle.b.x = _w/2 + 1; _triangle.b.y = _h/2;
@@ -116,15 +87,6 @@ static void init(int w, int h) {
   }
 }
 
-static void drawLineWithThickness(int x0, int y0, int x1, int y1, int t) {
-  int i;
-  for(i = 0; i < t; i++) {
-    gl4dpLine(x0 - i, y0 - i, x1 - i, y1 - i);
-    gl4dpLine(x0, y0, x1, y1);
-    gl4dpLine(x0 + i, y0 + i, x1 + i, y1 + i);
-  }
-}
-
 static void triangleMove(void) {
   _triangle.a.x -= 15; _triangle.a.y -= 15;
   _triangle.b.x += 15; _triangle.b.y -= 15;
@@ -139,23 +101,13 @@ static void triangleMove(void) {
 
 static void triangleDraw(void) {
   gl4dpSetColor(RGB(255,255,255));
-  drawLineWithThickness(_triangle.a.x, _triangle.a.y, _triangle.b.x, _triangle.b.y, 5);
-  drawLineWithThickness(_triangle.b.x, _triangle.b.y, _triangle.c.x, _triangle.c.y, 5);
-  drawLineWithThickness(_triangle.c.x, _triangle.c.y, _triangle.a.x, _triangle.a.y, 5);
+  dhLine(_triangle.a.x, _triangle.a.y, _triangle.b.x, _triangle.b.y, TRIANGLE_THICKNESS);
+  dhLine(_triangle.b.x, _triangle.b.y, _triangle.c.x, _triangle.c.y, TRIANGLE_THICKNESS);
+  dhLine(_triangle.c.x, _triangle.c.y, _triangle.a.x, _triangle.a.y, TRIANGLE_THICKNESS);
 }
 
 static void lineMove(void) {
-  static 
-  int i;
-  for(i = 0; i < _nb_lines; i++) {
-    _line[i].z -= _speed;
-    if(_line[i].z < 1) {
-      _line[i].z = _w;
-      _line[i].x = myRand(_w);
-      _line[i].y = myRand(_h);
-      _line[i].pz = _line[i].z; 
-    }
-  }
+  sfUpdate(_speed);
 
   if(_speed > 5) {
     _speed -= 0.5;
@@ -165,16 +117,7 @@ static void lineMove(void) {
 
 static void lineDraw(void) {
   static float lf = 0.0;
-  int i;
-  float sx, sy, px, py;
   gl4dpSetColor(RGB(255, 255, 255)); 
-  for(i = 0; i < _nb_lines; i++) {
-    sx = (_line[i].x / _line[i].z) * _w + _w/2;
-    sy = (_line[i].y / _line[i].z) * _h + _h/2;
-    px = (_line[i].x / _line[i].pz) * _w + _w/2;
-    py = (_line[i].y / _line[i].pz) * _h + _h/2;
-    gl4dpLine(px, py, sx, sy);
-  }
 
   int r = (int)_basses * 10;
   gl4dpFilledCircle(_w/2, _h/2, r);
@@ -191,9 +134,9 @@ static void lineDraw(void) {
   float theta, radius;
   gl4dpSetColor(RGB(255, 255, 255));
 
-  for(ip = 0.0; ip < _nb_lines; ip += 1.0) {
+  for(ip = 0.0; ip < _nb_spiral; ip += 1.0) {
     theta = _angle * ip;
-    radius = _maxRad * sqrt(ip/_nb_lines);
+    radius = _maxRad * sqrt(ip/_nb_spiral);
     x = _w/2 + radius * cos(theta);
     y = _h/2 + radius * sin(theta);
     gl4dpSetColor(RGB(2, 2, 2));
@@ -207,10 +150,7 @@ static void lineDraw(void) {
 }
 
 static void quit(void) {
-  if(_line) {
-    free(_line);
-    _line = NULL;
-  }
+  sfDelete();
 
   if(_screen) {
     gl4dpSetScreen(_screen);
@@ -249,6 +189,9 @@ void space(int state) {
     default:
       draw();
       gl4dpUpdateScreen(NULL);
+      shInvalidate(SH_PROGRAM_BIT | SH_TEXTURE_BIT | SH_ENABLE_BIT);
+      /* les traînées d'étoiles sont dessinées par le GPU, en un seul appel */
+      sfDraw(RGB(255, 255, 255));
       return;
   }
 }
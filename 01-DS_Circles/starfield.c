@@ -0,0 +1,216 @@
+#include "starfield.h"
+#include "variantHelper.h"
+#include "stateHelper.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <GL4D/gl4dp.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define SF_AVX2 1
+#  include <immintrin.h>
+#endif
+
+/*!\brief nombre d'étoiles */
+static int _n = 0;
+/*!\brief dimensions de l'écran */
+static int _w = 1, _h = 1;
+/*!\brief coordonnées des étoiles (structure de tableaux), pz est la
+ * profondeur au moment de l'apparition de l'étoile */
+static float * _x = NULL, * _y = NULL, * _z = NULL, * _pz = NULL;
+/*!\brief graine xorshift propre à chaque étoile */
+static uint32_t * _seed = NULL;
+/*!\brief segments projetés (px, py, sx, sy), un tableau par
+ * composante, envoyés tels quels au GPU */
+static float * _seg = NULL;
+/*!\brief identifiants GL : programme, VAO et VBO des segments */
+static GLuint _pId = 0, _vao = 0, _buffer = 0;
+/*!\brief emplacements des uniforms du programme */
+enum { U_DIM = 0, U_COLOR, U_NB };
+static const char * const _uNames[U_NB] = { "dim", "color" };
+static GLint _u[U_NB];
+/*!\brief vaut 1 si le processeur supporte AVX2 */
+static int _avx2 = 0;
+
+static inline uint32_t xorshift(uint32_t s) {
+  s ^= s << 13;
+  s ^= s >> 17;
+  s ^= s << 5;
+  return s;
+}
+
+/*!\brief nombre aléatoire dans [-\a max, \a max] tiré de la graine \a s */
+static inline float sRand(uint32_t s, float max) {
+  return ((s >> 8) * (2.0f / 16777216.0f) - 1.0f) * max;
+}
+
+/*!\brief déplace, fait réapparaître et projette les étoiles [\a i0,
+ * \a i1[ (version scalaire). */
+static void updateScalar(int i0, int i1, float speed) {
+  int i;
+  float * px = _seg, * py = _seg + _n, * sx = _seg + 2 * _n, * sy = _seg + 3 * _n;
+  for(i = i0; i < i1; i++) {
+    if((_z[i] -= speed) < 1.0f) {
+      _seed[i] = xorshift(_seed[i]);
+      _x[i] = sRand(_seed[i], _w);
+      _seed[i] = xorshift(_seed[i]);
+      _y[i] = sRand(_seed[i], _h);
+      _z[i] = _pz[i] = _w;
+    }
+    sx[i] = (_x[i] / _z[i])  * _w + _w / 2;
+    sy[i] = (_y[i] / _z[i])  * _h + _h / 2;
+    px[i] = (_x[i] / _pz[i]) * _w + _w / 2;
+    py[i] = (_y[i] / _pz[i]) * _h + _h / 2;
+  }
+}
+
+#ifdef SF_AVX2
+static inline __attribute__((target("avx2"))) __m256i xorshift8(__m256i s) {
+  s = _mm256_xor_si256(s, _mm256_slli_epi32(s, 13));
+  s = _mm256_xor_si256(s, _mm256_srli_epi32(s, 17));
+  return _mm256_xor_si256(s, _mm256_slli_epi32(s, 5));
+}
+
+static inline __attribute__((target("avx2"))) __m256 sRand8(__m256i s, __m256 max) {
+  __m256 u = _mm256_cvtepi32_ps(_mm256_srli_epi32(s, 8));
+  u = _mm256_sub_ps(_mm256_mul_ps(u, _mm256_set1_ps(2.0f / 16777216.0f)), _mm256_set1_ps(1.0f));
+  return _mm256_mul_ps(u, max);
+}
+
+/*!\brief même travail que updateScalar, huit étoiles à la fois.
+ * \return l'indice de la première étoile non traitée.
+ */
+static __attribute__((target("avx2"))) int updateAVX2(float speed) {
+  int i;
+  float * px = _seg, * py = _seg + _n, * sx = _seg + 2 * _n, * sy = _seg + 3 * _n;
+  const __m256 vspeed = _mm256_set1_ps(speed), one = _mm256_set1_ps(1.0f);
+  const __m256 w = _mm256_set1_ps(_w), h = _mm256_set1_ps(_h);
+  const __m256 hw = _mm256_set1_ps(_w / 2), hh = _mm256_set1_ps(_h / 2);
+  for(i = 0; i + 8 <= _n; i += 8) {
+    __m256 x, y, pz, z = _mm256_sub_ps(_mm256_loadu_ps(&_z[i]), vspeed);
+    __m256 m = _mm256_cmp_ps(z, one, _CMP_LT_OQ), iz, ipz;
+    x  = _mm256_loadu_ps(&_x[i]);
+    y  = _mm256_loadu_ps(&_y[i]);
+    pz = _mm256_loadu_ps(&_pz[i]);
+    /* réapparition, uniquement si au moins une étoile est passée
+     * derrière la caméra */
+    if(_mm256_movemask_ps(m)) {
+      __m256i s0 = _mm256_loadu_si256((__m256i *)&_seed[i]), s1, s2;
+      s1 = xorshift8(s0);
+      s2 = xorshift8(s1);
+      x  = _mm256_blendv_ps(x, sRand8(s1, w), m);
+      y  = _mm256_blendv_ps(y, sRand8(s2, h), m);
+      z  = _mm256_blendv_ps(z, w, m);
+      pz = _mm256_blendv_ps(pz, w, m);
+      _mm256_storeu_si256((__m256i *)&_seed[i], _mm256_blendv_epi8(s0, s2, _mm256_castps_si256(m)));
+      _mm256_storeu_ps(&_x[i], x);
+      _mm256_storeu_ps(&_y[i], y);
+      _mm256_storeu_ps(&_pz[i], pz);
+    }
+    _mm256_storeu_ps(&_z[i], z);
+    /* projection perspective */
+    iz  = _mm256_div_ps(w, z);
+    ipz = _mm256_div_ps(w, pz);
+    _mm256_storeu_ps(&sx[i], _mm256_add_ps(_mm256_mul_ps(x, iz), hw));
+    _mm256_storeu_ps(&px[i], _mm256_add_ps(_mm256_mul_ps(x, ipz), hw));
+    iz  = _mm256_div_ps(h, z);
+    ipz = _mm256_div_ps(h, pz);
+    _mm256_storeu_ps(&sy[i], _mm256_add_ps(_mm256_mul_ps(y, iz), hh));
+    _mm256_storeu_ps(&py[i], _mm256_add_ps(_mm256_mul_ps(y, ipz), hh));
+  }
+  return i;
+}
+#endif
+
+/*!\brief initialise \a n étoiles pour un écran \a w x \a h ainsi que
+ * les objets GL servant à les dessiner. */
+void sfInit(int n, int w, int h) {
+  int i, a;
+  sfDelete();
+  _n = n; _w = w; _h = h;
+  _x    = malloc(_n * sizeof *_x);
+  _y    = malloc(_n * sizeof *_y);
+  _z    = malloc(_n * sizeof *_z);
+  _pz   = malloc(_n * sizeof *_pz);
+  _seed = malloc(_n * sizeof *_seed);
+  _seg  = malloc(4 * _n * sizeof *_seg);
+  assert(_x && _y && _z && _pz && _seed && _seg);
+  for(i = 0; i < _n; i++) {
+    _seed[i] = ((uint32_t)rand() << 1) | 1;
+    _x[i] = sRand(_seed[i] = xorshift(_seed[i]), _w);
+    _y[i] = sRand(_seed[i] = xorshift(_seed[i]), _h);
+    _z[i] = _pz[i] = gl4dmURand() * _w;
+  }
+#ifdef SF_AVX2
+  _avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+  if(!_pId) {
+    _pId = vhProgram("shaders/starfield.vs", "shaders/starfield.fs", NULL);
+    vhUniforms(_pId, _uNames, U_NB, _u);
+  }
+  glGenVertexArrays(1, &_vao);
+  glBindVertexArray(_vao);
+  glGenBuffers(1, &_buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+  glBufferData(GL_ARRAY_BUFFER, 4 * _n * sizeof *_seg, NULL, GL_STREAM_DRAW);
+  /* une composante par attribut, une instance par étoile */
+  for(a = 0; a < 4; a++) {
+    glEnableVertexAttribArray(a);
+    glVertexAttribPointer(a, 1, GL_FLOAT, GL_FALSE, 0, (const void *)(a * _n * sizeof *_seg));
+    glVertexAttribDivisor(a, 1);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+}
+
+/*!\brief avance les étoiles de \a speed, fait réapparaître celles
+ * passées derrière la caméra et calcule leurs segments projetés. */
+void sfUpdate(float speed) {
+  int i = 0;
+#ifdef SF_AVX2
+  if(_avx2)
+    i = updateAVX2(speed);
+#endif
+  updateScalar(i, _n, speed);
+}
+
+/*!\brief dessine en un seul appel toutes les traînées d'étoiles avec
+ * la couleur \a color (au format gl4dp). */
+void sfDraw(GLuint color) {
+  GLboolean dt = shIsEnabled(GL_DEPTH_TEST);
+  if(!_n) return;
+  shDisable(GL_DEPTH_TEST);
+  shUseProgram(_pId);
+  glUniform2f(_u[U_DIM], _w, _h);
+  glUniform4f(_u[U_COLOR], RED(color) / 255.0f, GREEN(color) / 255.0f, BLUE(color) / 255.0f, 1.0f);
+  glBindVertexArray(_vao);
+  glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+  glBufferData(GL_ARRAY_BUFFER, 4 * _n * sizeof *_seg, NULL, GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, 4 * _n * sizeof *_seg, _seg);
+  glDrawArraysInstanced(GL_LINES, 0, 2, _n);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+  shUseProgram(0);
+  if(dt)
+    shEnable(GL_DEPTH_TEST);
+}
+
+/*!\brief libère les étoiles et les objets GL associés. */
+void sfDelete(void) {
+  if(_buffer) {
+    glDeleteBuffers(1, &_buffer);
+    _buffer = 0;
+  }
+  if(_vao) {
+    glDeleteVertexArrays(1, &_vao);
+    _vao = 0;
+  }
+  free(_x);    _x = NULL;
+  free(_y);    _y = NULL;
+  free(_z);    _z = NULL;
+  free(_pz);   _pz = NULL;
+  free(_seed); _seed = NULL;
+  free(_seg);  _seg = NULL;
+  _n = 0;
+}
@@ -5,6 +5,9 @@
 #include <SDL_mixer.h>
 #include <GL4D/gl4dh.h>
 #include "audioHelper.h"
+#include "lodHelper.h"
+#include "variantHelper.h"
+#include "stateHelper.h"
 
 #define NTEXTURES 5
 
@@ -26,8 +29,16 @@ enum {
 
 static int _w, _h;
 static GLuint _pId = 0;
+/*!\brief programme des sphères instanciées et leur texture tableau */
+static GLuint _ipId = 0;
+static GLuint _taId = 0;
 static GLuint _tId[NTEXTURES] = {0};
 static GLuint _screen = 0;
+/*!\brief uniforms des deux programmes, relevés à l'initialisation (le
+ * temps vient du bloc "frame") */
+enum { U_TEX0 = 0, U_DISCO, U_GAP, U_IMPOSTOR, U_NB };
+static const char * const _uNames[U_NB] = { "tex0", "disco", "gap", "impostor" };
+static GLint _u[U_NB], _iu[U_NB];
 
 static int _state = 0;
 static float _basses = 0;
@@ -53,15 +64,19 @@ static float myRand(float max) {
 
 static void initGL(void) {
 
-  _pId  = gl4duCreateProgram("<vs>shaders/stars.vs", "<fs>shaders/stars.fs", NULL);
+  _pId  = vhProgram("shaders/stars.vs", "shaders/stars.fs", NULL);
+  _ipId = vhProgram("shaders/stars.vs", "shaders/stars.fs", "#define INSTANCED\n");
+  vhUniforms(_pId, _uNames, U_NB, _u);
+  vhUniforms(_ipId, _uNames, U_NB, _iu);
   gl4duGenMatrix(GL_FLOAT, "modelViewMatrix");
   gl4duGenMatrix(GL_FLOAT, "projectionMatrix");
+  lhInit();
 }
 
 static void initData(void) {
   int i;
   SDL_Surface * t;
-  static char * files[] = {
+  static const char * files[] = {
     "images/star00.png", 
     "images/star01.png",
     "images/star02.png",
@@ -74,7 +89,7 @@ static void initData(void) {
     glGenTextures(NTEXTURES, _tId);
   }
   for(i = 0; i < NTEXTURES; i++) {
-    glBindTexture(GL_TEXTURE_2D, _tId[i]);
+    shBindTexture(GL_TEXTURE_2D, _tId[i]);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     if( (t = IMG_Load(files[i])) != NULL ) {
@@ -87,6 +102,9 @@ static void initData(void) {
       glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
     }
   }
+  /* les couches 0 à 3 sont star01 à star04, en taille réduite */
+  if(!_taId)
+    _taId = lhTexArray(files + 1, 4, 512, 256);
   _sphere = gl4dgGenSpheref(30, 30);
 
   _nb_spheres = 200;
@@ -159,15 +177,14 @@ static void draw(void) {
   int i;
   GLint vp[4];
   GLfloat *mat;
-  GLfloat dt = 0.0;
   static GLfloat gap = 0.0;
-  GLboolean gdt = glIsEnabled(GL_DEPTH_TEST);
-  glGetIntegerv(GL_VIEWPORT, vp);
-  dt = SDL_GetTicks();
+  GLboolean gdt = shIsEnabled(GL_DEPTH_TEST);
+  shGetViewport(vp);
 
   gl4duBindMatrix("projectionMatrix");
   gl4duLoadIdentityf();
   gl4duFrustumf(-0.5, 0.5, -0.5 * vp[3] / vp[2], 0.5 * vp[3] / vp[2], 1.0, 1000.0);
+  lhBegin();
   gl4duBindMatrix("modelViewMatrix");
   gl4duLoadIdentityf();
 
@@ -189,18 +206,16 @@ static void draw(void) {
   glClearColor(0.13f, 0.14f, 0.60f, 0.0f);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   mat = gl4duGetMatrixData();
-  glDisable(GL_CULL_FACE);
-  glEnable(GL_DEPTH_TEST);
-  glDisable(GL_BLEND);
-  glUseProgram(_pId);
-
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, (_state > 3 ? _tId[0] : 0));
-  glUniform1i(glGetUniformLocation(_pId, "tex0"), 0);
-  glUniform1i(glGetUniformLocation(_pId, "tex1"), 1);
-  glUniform1i(glGetUniformLocation(_pId, "temps"), dt);
-  glUniform1i(glGetUniformLocation(_pId, "disco"), _disco);
-  glUniform1f(glGetUniformLocation(_pId, "gap"), gap);
+  shDisable(GL_CULL_FACE);
+  shEnable(GL_DEPTH_TEST);
+  shDisable(GL_BLEND);
+  shUseProgram(_pId);
+
+  shActiveTexture(GL_TEXTURE0);
+  shBindTexture(GL_TEXTURE_2D, (_state > 3 ? _tId[0] : 0));
+  glUniform1i(_u[U_TEX0], 0);
+  glUniform1i(_u[U_DISCO], _disco);
+  glUniform1f(_u[U_GAP], gap);
 
   gl4duPushMatrix(); {
     gl4duRotatef(0, 0, 1, 0);
@@ -208,36 +223,47 @@ static void draw(void) {
     gl4duSendMatrices();
   } gl4duPopMatrix();
   gl4dgDraw(_sphere);
-  glActiveTexture(GL_TEXTURE1);
-  glBindTexture(GL_TEXTURE_2D, 0);
-
+  shActiveTexture(GL_TEXTURE1);
+  shBindTexture(GL_TEXTURE_2D, 0);
+
+  /* le champ de sphères : une instance chacune, dessinées en un appel
+   * par niveau de détail */
+  shUseProgram(_ipId);
+  shActiveTexture(GL_TEXTURE0);
+  shBindTexture(GL_TEXTURE_2D_ARRAY, _taId);
+  glUniform1i(_iu[U_TEX0], 0);
+  glUniform1i(_iu[U_DISCO], 0);
+  glUniform1f(_iu[U_GAP], gap);
   for(i = 0; i < _nb_spheres; i++) {
-    int id = (gl4dmURand() * 4.0) + 1.0;
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, (_state > 3 ? _tId[id] : 0));
-    gl4duPushMatrix(); {
-      gl4duTranslatef(_sph_att[i * 4 + 0], _sph_att[i * 4 + 1], _sph_w  * _sph_att[i * 4 + 2]);  
-      gl4duScalef(_sph_att[i * 4 + 3], _sph_att[i * 4 + 3] , _sph_att[i * 4 + 3]);
-      gl4duSendMatrices();
-    } gl4duPopMatrix();
-    glUniform1i(glGetUniformLocation(_pId, "disco"), 0);
-    gl4dgDraw(_sphere);
+    static const GLfloat black[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    int layer = gl4dmURand() * 4.0;
+    /* sans texture (donc noires) avant l'état 4 */
+    lhAdd(_sph_att[i * 4 + 0], _sph_att[i * 4 + 1], _sph_w  * _sph_att[i * 4 + 2],
+          _sph_att[i * 4 + 3], _state > 3 ? NULL : black, layer);
   }
+  gl4duSendMatrices();
+  lhDraw(_iu[U_IMPOSTOR]);
+  shBindTexture(GL_TEXTURE_2D_ARRAY, 0);
   
   _sph_w += (_sph_w < 8.0 ? (_state >= 6 ? 0.01 : 0) : 0);
   sphereMove();
   gap += 0.01;
   
   if(!gdt)
-    glDisable(GL_DEPTH_TEST);
+    shDisable(GL_DEPTH_TEST);
 }
 
 
 static void quit(void) {
+  lhClean();
   if(_tId[0]) {
     glDeleteTextures(NTEXTURES, _tId);
     _tId[0] = 0;
   }
+  if(_taId) {
+    glDeleteTextures(1, &_taId);
+    _taId = 0;
+  }
 
   if(_screen) {
     gl4dpSetScreen(_screen);
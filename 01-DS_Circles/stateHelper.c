@@ -0,0 +1,296 @@
+#include "stateHelper.h"
+#include <string.h>
+
+/*!\brief nombre d'unités de texture suivies ; au-delà, les appels sont
+ * transmis tels quels */
+#define SH_UNITS 8
+/*!\brief nombre d'attachements (framebuffer, point d'attache) retenus */
+#define SH_ATTACHMENTS 16
+
+/*!\brief une valeur copiée de l'état GL et si elle est connue ; une
+ * valeur inconnue est demandée à GL à la première requête. */
+typedef struct shValue_t shValue_t;
+struct shValue_t {
+  GLint value;
+  int known;
+};
+
+/*!\brief un attachement de texture : le framebuffer, le point d'attache
+ * et la texture */
+typedef struct shAttachment_t shAttachment_t;
+struct shAttachment_t {
+  GLuint fbo;
+  GLenum attachment;
+  GLuint tId;
+};
+
+/*!\brief cibles de textures suivies par shBindTexture */
+static const GLenum _targets[] = { GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY };
+#define SH_TARGETS ((int)(sizeof _targets / sizeof *_targets))
+/*!\brief capacités suivies par shEnable, shDisable et shIsEnabled */
+static const GLenum _caps[] = { GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, GL_SCISSOR_TEST };
+#define SH_CAPS ((int)(sizeof _caps / sizeof *_caps))
+
+/*!\brief la copie de l'état */
+static shValue_t _program, _unit, _tex[SH_UNITS][SH_TARGETS], _draw, _read, _enabled[SH_CAPS];
+static shValue_t _viewport, _polygonMode;
+static GLint _vp[4];
+static shAttachment_t _attachments[SH_ATTACHMENTS];
+static int _nbAttachments = 0;
+/*!\brief compteurs de la frame en cours et de la précédente */
+static shStats_t _cur, _last;
+
+/*!\brief renvoie vrai s'il faut transmettre à GL le passage de \a v à
+ * \a value, et met la copie à jour. */
+static int set(shValue_t * v, GLint value) {
+  if(v->known && v->value == value) {
+    _cur.saved++;
+    return 0;
+  }
+  v->value = value;
+  v->known = 1;
+  _cur.issued++;
+  return 1;
+}
+
+/*!\brief renvoie la valeur de \a v, demandée à GL par \a pname si elle
+ * n'est pas connue. */
+static GLint get(shValue_t * v, GLenum pname) {
+  if(v->known)
+    _cur.answered++;
+  else {
+    glGetIntegerv(pname, &v->value);
+    v->known = 1;
+    _cur.queried++;
+  }
+  return v->value;
+}
+
+/*!\brief renvoie l'indice de \a target dans _targets, -1 sinon. */
+static int targetIndex(GLenum target) {
+  int i;
+  for(i = 0; i < SH_TARGETS; i++)
+    if(_targets[i] == target)
+      return i;
+  return -1;
+}
+
+/*!\brief renvoie l'indice de \a cap dans _caps, -1 sinon. */
+static int capIndex(GLenum cap) {
+  int i;
+  for(i = 0; i < SH_CAPS; i++)
+    if(_caps[i] == cap)
+      return i;
+  return -1;
+}
+
+/*!\brief renvoie l'attachement \a attachment du framebuffer de dessin
+ * courant, en le créant (texture inconnue) s'il n'est pas retenu ;
+ * quand la table est pleine, elle est vidée. */
+static shAttachment_t * findAttachment(GLenum attachment) {
+  int i;
+  GLuint fbo = shFramebuffer(GL_DRAW_FRAMEBUFFER);
+  for(i = 0; i < _nbAttachments; i++)
+    if(_attachments[i].fbo == fbo && _attachments[i].attachment == attachment)
+      return &_attachments[i];
+  if(_nbAttachments == SH_ATTACHMENTS)
+    _nbAttachments = 0;
+  _attachments[_nbAttachments].fbo = fbo;
+  _attachments[_nbAttachments].attachment = attachment;
+  _attachments[_nbAttachments].tId = (GLuint)-1;
+  return &_attachments[_nbAttachments++];
+}
+
+/*!\brief début de frame : garde les compteurs de la frame qui s'achève
+ * (voir shStats) et oublie ce que gl4dh change directement entre deux
+ * frames : son dessin à l'écran (programme, textures, capacités) et le
+ * viewport. Le framebuffer de gl4dh, lié avant chaque animation, et sa
+ * texture restent connus d'une frame à l'autre ; ils ne changent qu'au
+ * redimensionnement (voir resize dans window.c). */
+void shFrame(void) {
+  _last = _cur;
+  memset(&_cur, 0, sizeof _cur);
+  shInvalidate(SH_PROGRAM_BIT | SH_TEXTURE_BIT | SH_VIEWPORT_BIT | SH_ENABLE_BIT);
+}
+
+/*!\brief oublie les parties \a bits (voir shBits_t) de l'état copié ;
+ * à appeler après tout code qui les modifie sans passer par cette
+ * couche. */
+void shInvalidate(GLbitfield bits) {
+  int i, j;
+  if(bits & SH_PROGRAM_BIT)
+    _program.known = 0;
+  if(bits & SH_TEXTURE_BIT) {
+    _unit.known = 0;
+    for(i = 0; i < SH_UNITS; i++)
+      for(j = 0; j < SH_TARGETS; j++)
+        _tex[i][j].known = 0;
+  }
+  if(bits & SH_FRAMEBUFFER_BIT)
+    _draw.known = _read.known = 0;
+  if(bits & SH_ATTACHMENT_BIT)
+    _nbAttachments = 0;
+  if(bits & SH_VIEWPORT_BIT)
+    _viewport.known = 0;
+  if(bits & SH_ENABLE_BIT)
+    for(i = 0; i < SH_CAPS; i++)
+      _enabled[i].known = 0;
+  if(bits & SH_POLYGON_BIT)
+    _polygonMode.known = 0;
+}
+
+/*!\brief renvoie les compteurs de la dernière frame terminée. */
+const shStats_t * shStats(void) {
+  return &_last;
+}
+
+void shUseProgram(GLuint pId) {
+  if(set(&_program, pId))
+    glUseProgram(pId);
+}
+
+GLuint shProgram(void) {
+  return get(&_program, GL_CURRENT_PROGRAM);
+}
+
+void shActiveTexture(GLenum unit) {
+  if(set(&_unit, unit))
+    glActiveTexture(unit);
+}
+
+/*!\brief lie \a tId à \a target sur l'unité active ; les cibles et
+ * unités non suivies sont transmises telles quelles. */
+void shBindTexture(GLenum target, GLuint tId) {
+  int u = get(&_unit, GL_ACTIVE_TEXTURE) - GL_TEXTURE0, t = targetIndex(target);
+  if(u < 0 || u >= SH_UNITS || t < 0) {
+    _cur.issued++;
+    glBindTexture(target, tId);
+  } else if(set(&_tex[u][t], tId))
+    glBindTexture(target, tId);
+}
+
+/*!\brief lie \a fbo à \a target (GL_FRAMEBUFFER lie les deux cibles). */
+void shBindFramebuffer(GLenum target, GLuint fbo) {
+  int draw = target != GL_READ_FRAMEBUFFER, read = target != GL_DRAW_FRAMEBUFFER;
+  if((draw && (!_draw.known || _draw.value != (GLint)fbo)) ||
+     (read && (!_read.known || _read.value != (GLint)fbo))) {
+    if(draw) { _draw.value = fbo; _draw.known = 1; }
+    if(read) { _read.value = fbo; _read.known = 1; }
+    _cur.issued++;
+    glBindFramebuffer(target, fbo);
+  } else
+    _cur.saved++;
+}
+
+/*!\brief renvoie le framebuffer lié à \a target (GL_FRAMEBUFFER donne
+ * celui du dessin). */
+GLuint shFramebuffer(GLenum target) {
+  if(target == GL_READ_FRAMEBUFFER)
+    return get(&_read, GL_READ_FRAMEBUFFER_BINDING);
+  return get(&_draw, GL_DRAW_FRAMEBUFFER_BINDING);
+}
+
+/*!\brief attache \a tId au framebuffer de dessin courant ; mêmes
+ * paramètres que glFramebufferTexture2D, seule la texture est comparée. */
+void shFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint tId, GLint level) {
+  shAttachment_t * a = findAttachment(attachment);
+  if(a->tId == tId) {
+    _cur.saved++;
+    return;
+  }
+  a->tId = tId;
+  _cur.issued++;
+  glFramebufferTexture2D(target, attachment, textarget, tId, level);
+}
+
+/*!\brief renvoie la texture attachée en \a attachment au framebuffer de
+ * dessin courant. */
+GLuint shFramebufferTexture(GLenum attachment) {
+  shAttachment_t * a = findAttachment(attachment);
+  if(a->tId != (GLuint)-1)
+    _cur.answered++;
+  else {
+    GLint tId;
+    glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME, &tId);
+    a->tId = tId;
+    _cur.queried++;
+  }
+  return a->tId;
+}
+
+void shViewport(GLint x, GLint y, GLsizei w, GLsizei h) {
+  if(_viewport.known && _vp[0] == x && _vp[1] == y && _vp[2] == w && _vp[3] == h) {
+    _cur.saved++;
+    return;
+  }
+  _vp[0] = x; _vp[1] = y; _vp[2] = w; _vp[3] = h;
+  _viewport.known = 1;
+  _cur.issued++;
+  glViewport(x, y, w, h);
+}
+
+/*!\brief copie le viewport courant dans \a vp. */
+void shGetViewport(GLint * vp) {
+  if(_viewport.known)
+    _cur.answered++;
+  else {
+    glGetIntegerv(GL_VIEWPORT, _vp);
+    _viewport.known = 1;
+    _cur.queried++;
+  }
+  memcpy(vp, _vp, sizeof _vp);
+}
+
+void shEnable(GLenum cap) {
+  int c = capIndex(cap);
+  if(c < 0) {
+    _cur.issued++;
+    glEnable(cap);
+  } else if(set(&_enabled[c], GL_TRUE))
+    glEnable(cap);
+}
+
+void shDisable(GLenum cap) {
+  int c = capIndex(cap);
+  if(c < 0) {
+    _cur.issued++;
+    glDisable(cap);
+  } else if(set(&_enabled[c], GL_FALSE))
+    glDisable(cap);
+}
+
+GLboolean shIsEnabled(GLenum cap) {
+  int c = capIndex(cap);
+  if(c < 0) {
+    _cur.queried++;
+    return glIsEnabled(cap);
+  }
+  if(_enabled[c].known)
+    _cur.answered++;
+  else {
+    _enabled[c].value = glIsEnabled(cap);
+    _enabled[c].known = 1;
+    _cur.queried++;
+  }
+  return (GLboolean)_enabled[c].value;
+}
+
+/*!\brief fixe le mode \a mode des faces avant et arrière. */
+void shPolygonMode(GLenum mode) {
+  if(set(&_polygonMode, mode))
+    glPolygonMode(GL_FRONT_AND_BACK, mode);
+}
+
+/*!\brief renvoie le mode des polygones (celui des faces avant). */
+GLenum shGetPolygonMode(void) {
+  GLint pm[2];
+  if(_polygonMode.known)
+    _cur.answered++;
+  else {
+    glGetIntegerv(GL_POLYGON_MODE, pm);
+    _polygonMode.value = pm[0];
+    _polygonMode.known = 1;
+    _cur.queried++;
+  }
+  return (GLenum)_polygonMode.value;
+}
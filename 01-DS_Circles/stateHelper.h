@@ -0,0 +1,62 @@
+#ifndef _STATE_HELPER_H
+
+#define _STATE_HELPER_H
+
+#include <GL4D/gl4du.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  /*!\brief compteurs d'une frame (voir shFrame et shStats) */
+  typedef struct shStats_t shStats_t;
+  struct shStats_t {
+    unsigned int issued;   /* changements d'état transmis à GL */
+    unsigned int saved;    /* changements redondants évités */
+    unsigned int answered; /* requêtes servies par la copie */
+    unsigned int queried;  /* requêtes qui ont dû interroger GL */
+  };
+
+  /*!\brief parties de l'état copié, à passer à shInvalidate */
+  enum shBits_t {
+    SH_PROGRAM_BIT     = 1 << 0, /* programme */
+    SH_TEXTURE_BIT     = 1 << 1, /* unité active et textures liées */
+    SH_FRAMEBUFFER_BIT = 1 << 2, /* framebuffers liés */
+    SH_ATTACHMENT_BIT  = 1 << 3, /* attachements des framebuffers */
+    SH_VIEWPORT_BIT    = 1 << 4, /* viewport */
+    SH_ENABLE_BIT      = 1 << 5, /* capacités de shEnable */
+    SH_POLYGON_BIT     = 1 << 6, /* mode des polygones */
+    SH_ALL_BITS        = (1 << 7) - 1
+  };
+
+  /* L'état copié (programme, unité active, textures 2D et tableaux par
+   * unité, framebuffers et leurs attachements de textures, viewport,
+   * test de profondeur, culling, blending, ciseaux et mode des
+   * polygones) n'est juste que si tout changement passe par ces
+   * fonctions. Un code qui en modifie une partie directement (gl4dp,
+   * gl4df) doit être suivi de shInvalidate sur cette partie ; ce que
+   * gl4dh change entre deux frames est oublié par shFrame. */
+  extern void              shFrame(void);
+  extern void              shInvalidate(GLbitfield bits);
+  extern const shStats_t * shStats(void);
+  extern void              shUseProgram(GLuint pId);
+  extern GLuint            shProgram(void);
+  extern void              shActiveTexture(GLenum unit);
+  extern void              shBindTexture(GLenum target, GLuint tId);
+  extern void              shBindFramebuffer(GLenum target, GLuint fbo);
+  extern GLuint            shFramebuffer(GLenum target);
+  extern void              shFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint tId, GLint level);
+  extern GLuint            shFramebufferTexture(GLenum attachment);
+  extern void              shViewport(GLint x, GLint y, GLsizei w, GLsizei h);
+  extern void              shGetViewport(GLint * vp);
+  extern void              shEnable(GLenum cap);
+  extern void              shDisable(GLenum cap);
+  extern GLboolean         shIsEnabled(GLenum cap);
+  extern void              shPolygonMode(GLenum mode);
+  extern GLenum            shGetPolygonMode(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
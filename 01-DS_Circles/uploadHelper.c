@@ -0,0 +1,125 @@
+#include "uploadHelper.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*!\brief nombre de régions de l'anneau : le CPU écrit dans l'une
+ * pendant que le GPU lit les précédentes */
+#define UH_RING 3
+
+/*!\brief anneau de buffers vus comme textures (GL_TEXTURE_BUFFER)
+ * servant à envoyer les mobiles au GPU. */
+struct uhRing_t {
+  GLsizeiptr size;
+  GLuint buffer[UH_RING], tex[UH_RING];
+  GLsync fence[UH_RING];
+  /*!\brief adresses persistantes (ARB_buffer_storage), NULL sinon */
+  void * ptr[UH_RING];
+  /*!\brief région en cours d'écriture et dernière région envoyée */
+  int cur, last;
+};
+
+/*!\brief vaut 1 si le contexte permet un mapping persistant. */
+static int hasBufferStorage(void) {
+#ifdef GL_MAP_PERSISTENT_BIT
+  GLint i, n = 0, major = 0, minor = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &major);
+  glGetIntegerv(GL_MINOR_VERSION, &minor);
+  if(major > 4 || (major == 4 && minor >= 4))
+    return 1;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &n);
+  for(i = 0; i < n; i++)
+    if(!strcmp((const char *)glGetStringi(GL_EXTENSIONS, i), "GL_ARB_buffer_storage"))
+      return 1;
+#endif
+  return 0;
+}
+
+/*!\brief crée un anneau de trois régions de \a size octets chacune,
+ * lues dans les shaders comme des textures de format \a format
+ * (GL_RGBA32F, GL_R32I, ...). Les régions sont allouées une fois pour
+ * toutes et, si le pilote le permet, mappées de façon persistante. */
+uhRing_t * uhNew(GLsizeiptr size, GLenum format) {
+  int i, persistent = hasBufferStorage();
+  uhRing_t * r = calloc(1, sizeof *r);
+  assert(r);
+  r->size = size;
+  r->last = -1;
+  glGenBuffers(UH_RING, r->buffer);
+  glGenTextures(UH_RING, r->tex);
+  for(i = 0; i < UH_RING; i++) {
+    glBindBuffer(GL_TEXTURE_BUFFER, r->buffer[i]);
+#ifdef GL_MAP_PERSISTENT_BIT
+    if(persistent) {
+      const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glBufferStorage(GL_TEXTURE_BUFFER, size, NULL, flags);
+      r->ptr[i] = glMapBufferRange(GL_TEXTURE_BUFFER, 0, size, flags);
+    } else
+#endif
+      glBufferData(GL_TEXTURE_BUFFER, size, NULL, GL_STREAM_DRAW);
+    glBindTexture(GL_TEXTURE_BUFFER, r->tex[i]);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, r->buffer[i]);
+  }
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+  return r;
+}
+
+/*!\brief renvoie l'adresse où écrire les données de la frame. La
+ * région envoyée précédemment est protégée par une barrière (les
+ * commandes qui la lisent ont toutes été émises) et on attend, si
+ * besoin, que le GPU ait fini de lire la région courante. */
+void * uhMap(uhRing_t * r) {
+  void * p;
+  int i = r->cur;
+  if(r->last >= 0) {
+    r->fence[r->last] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    r->last = -1;
+  }
+  if(r->fence[i]) {
+    while(glClientWaitSync(r->fence[i], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED);
+    glDeleteSync(r->fence[i]);
+    r->fence[i] = 0;
+  }
+  if(r->ptr[i])
+    return r->ptr[i];
+  glBindBuffer(GL_TEXTURE_BUFFER, r->buffer[i]);
+  p = glMapBufferRange(GL_TEXTURE_BUFFER, 0, r->size,
+                       GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+  return p;
+}
+
+/*!\brief termine l'écriture de la frame et passe à la région suivante.
+ * \return l'identifiant de la texture (GL_TEXTURE_BUFFER) à lier pour
+ * lire les données écrites.
+ */
+GLuint uhCommit(uhRing_t * r) {
+  int i = r->cur;
+  if(!r->ptr[i]) {
+    glBindBuffer(GL_TEXTURE_BUFFER, r->buffer[i]);
+    glUnmapBuffer(GL_TEXTURE_BUFFER);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+  }
+  r->last = i;
+  r->cur = (i + 1) % UH_RING;
+  return r->tex[i];
+}
+
+/*!\brief libère l'anneau \a r. */
+void uhDelete(uhRing_t * r) {
+  int i;
+  if(!r) return;
+  for(i = 0; i < UH_RING; i++) {
+    if(r->fence[i])
+      glDeleteSync(r->fence[i]);
+    if(r->ptr[i]) {
+      glBindBuffer(GL_TEXTURE_BUFFER, r->buffer[i]);
+      glUnmapBuffer(GL_TEXTURE_BUFFER);
+    }
+  }
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+  glDeleteTextures(UH_RING, r->tex);
+  glDeleteBuffers(UH_RING, r->buffer);
+  free(r);
+}
@@ -0,0 +1,32 @@
+#ifndef _VARIANT_HELPER_H
+
+#define _VARIANT_HELPER_H
+
+#include <GL4D/gl4du.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  /*!\brief valeurs communes à toute une frame, rangées comme le bloc
+   * std140 "frame" des shaders (voir vhFrame) */
+  typedef struct vhFrame_t vhFrame_t;
+  struct vhFrame_t {
+    GLfloat resolution[4]; /* largeur, hauteur, 1 / largeur, 1 / hauteur */
+    GLfloat time;          /* SDL_GetTicks, en millisecondes */
+    GLfloat basses, aigus; /* ahGetAudioStreamFreq et ahGetAudioStreamAigus */
+    GLfloat pad;
+  };
+
+  extern GLuint vhProgram(const char * vs, const char * fs, const char * defines);
+  extern int    vhPrepare(const char * vs, const char * fs, const char * defines);
+  extern int    vhPending(void);
+  extern void   vhUniforms(GLuint pId, const char * const * names, int n, GLint * loc);
+  extern void   vhFrame(const vhFrame_t * f);
+  extern void   vhClean(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -6,6 +6,13 @@
 #include <fftw3.h>
 #include <GL4D/gl4dh.h>
 #include "audioHelper.h"
+#include "uploadHelper.h"
+#include "variantHelper.h"
+#include "jobHelper.h"
+#include "stateHelper.h"
+
+/*!\brief nombre de mobiles par tranche de jhRun */
+#define MOBILE_GRAIN 100
 
 typedef struct mobile_t mobile_t;
 struct mobile_t {
@@ -20,10 +27,12 @@ static void         draw(void);
 static void         quit(void);
 static void         mobileIntersect(void);
 static void         mobileInit(void);
-static void         mobile2texture(float * f);
+static void         mobileJob(int first, int last, void * data, jhList_t * list);
 static int          distance(int x0, int y0, int x1, int y1);
 static int          bestMove(mobile_t mobile);
 static void         mobileMove(void);
+static int          jumpFloodingPass(int k, int src);
+static int          jumpFlooding(void);
 
 enum { NOTHING, LEFT, LEFT_UP, UP, RIGHT_UP, RIGHT, RIGHT_DOWN, DOWN, LEFT_DOWN, NDIR };
 enum { EYES10, EYES11, EYES20, EYES21, NEYES };
@@ -31,9 +40,24 @@ enum { EYES10, EYES11, EYES20, EYES21, NEYES };
 
 static int _hasInit = 0;
 static int _w = 1, _h = 1;
-static GLuint _pId = 0;
-static GLuint _tId = 0;
+/*!\brief variantes du programme d'affichage : balles puis diagramme
+ * de Voronoï (VORONOI) */
+static GLuint _pId[2] = {0};
 static GLuint _screen = 0;
+/*!\brief programmes du placement des sites et des passes de jump
+ * flooding */
+static GLuint _seedPId = 0, _jfaPId = 0;
+/*!\brief emplacements des uniforms des programmes d'affichage, de
+ * placement et de jump flooding */
+enum { U_MOBILES = 0, U_IDS, U_DIM, U_NBALLS, U_K, U_NB };
+static const char * const _uNames[U_NB] = { "mobiles", "ids", "dim", "nballs", "k" };
+static GLint _u[2][U_NB], _seedU[U_NB], _jfaU[U_NB];
+/*!\brief anneau d'envoi des sites (couleur puis position), lu par
+ * identifiant dans les shaders */
+static uhRing_t * _ring = NULL;
+/*!\brief textures ping-pong des deux sites les plus proches de chaque
+ * pixel, FBO et VAO vide servant au placement des sites */
+static GLuint _idTex[2] = {0}, _fbo = 0, _vao = 0;
 
 static mobile_t * _mobile = NULL;
 static const int _nb_mobiles = 400;
@@ -105,23 +129,42 @@ static void mobileInit(void) {
 }
 
 static void init(int w, int h) {
+  int i;
   _w = w; _h = h;
   glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-  _pId = gl4duCreateProgram("<vs>shaders/voronoi.vs", "<fs>shaders/voronoi.fs", NULL);
+  _pId[0] = vhProgram("shaders/voronoi.vs", "shaders/voronoi.fs", NULL);
+  _pId[1] = vhProgram("shaders/voronoi.vs", "shaders/voronoi.fs", "#define VORONOI\n");
+  _seedPId = vhProgram("shaders/voronoiSeed.vs", "shaders/voronoiSeed.fs", NULL);
+  _jfaPId = vhProgram("shaders/voronoi.vs", "shaders/voronoiJFA.fs", NULL);
+  for(i = 0; i < 2; i++)
+    vhUniforms(_pId[i], _uNames, U_NB, _u[i]);
+  vhUniforms(_seedPId, _uNames, U_NB, _seedU);
+  vhUniforms(_jfaPId, _uNames, U_NB, _jfaU);
   _quad = gl4dgGenQuadf();
-  glGenTextures(1, &_tId);
-  glBindTexture(GL_TEXTURE_1D, _tId);
-  glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA32F, 1, 0, GL_RGBA, GL_FLOAT, NULL);
-  glBindTexture(GL_TEXTURE_1D, 0);
+  _ring = uhNew(_nb_mobiles * 8 * sizeof(GLfloat), GL_RGBA32F);
+  jhInit();
+  glGenTextures(2, _idTex);
+  for(i = 0; i < 2; i++) {
+    glBindTexture(GL_TEXTURE_2D, _idTex[i]);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32I, _w, _h, 0, GL_RG_INTEGER, GL_INT, NULL);
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glGenFramebuffers(1, &_fbo);
+  glGenVertexArrays(1, &_vao);
   mobileInit();
 }
 
-static void mobile2texture(float * f) {
+/*!\brief job de jhRun : écrit les mobiles [\a first, \a last[ dans
+ * \a data, la région de l'anneau en cours d'écriture ; aucune commande
+ * n'est enregistrée. */
+static void mobileJob(int first, int last, void * data, jhList_t * list) {
   int i;
-  for(i = 0; i < _nb_mobiles; i++) {
+  float * f = data;
+  for(i = first; i < last; i++) {
     f[8 * i + 0] = _mobile[i].color[0];
     f[8 * i + 1] = _mobile[i].color[1];
     f[8 * i + 2] = _mobile[i].color[2];
@@ -190,28 +233,86 @@ static void mobileMove(void) {
   lf = _basses;
 }
 
-static void draw(void) {
-  GLfloat * f = malloc(_nb_mobiles * 8 * sizeof *f), step = 1.0 / (_nb_mobiles * 2);
-  assert(f);
-  glDisable(GL_DEPTH_TEST);
-  glUseProgram(_pId);
+/*!\brief une passe de jump flooding de pas \a k lisant
+ * \a _idTex[\a src].
+ * \return l'indice de la texture écrite.
+ */
+static int jumpFloodingPass(int k, int src) {
+  shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _idTex[!src], 0);
+  shBindTexture(GL_TEXTURE_2D, _idTex[src]);
+  glUniform1i(_jfaU[U_K], k);
+  gl4dgDraw(_quad);
+  return !src;
+}
+
+/*!\brief calcule par jump flooding les deux sites les plus proches de
+ * chaque pixel : les sites sont placés dans une texture puis
+ * log2(résolution) passes ping-pong (plus une passe de pas 1 pour
+ * affiner le second site) propagent les candidats. Le coût ne dépend
+ * plus du nombre de sites que par le placement initial.
+ * \return l'indice dans \a _idTex de la texture résultat.
+ */
+static int jumpFlooding(void) {
+  GLint vp[4];
+  GLuint fbo = shFramebuffer(GL_DRAW_FRAMEBUFFER);
+  const GLint none[] = { -1, -1, 0, 0 };
+  int k, src = 0, n = 1;
+  shGetViewport(vp);
+  shBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+  shViewport(0, 0, _w, _h);
+
+  shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _idTex[0], 0);
+  glClearBufferiv(GL_COLOR, 0, none);
+  shUseProgram(_seedPId);
+  glUniform1i(_seedU[U_MOBILES], 0);
+  glUniform2f(_seedU[U_DIM], _w, _h);
+  glBindVertexArray(_vao);
+  glDrawArrays(GL_POINTS, 0, _nb_mobiles);
+  glBindVertexArray(0);
 
-  glClear(GL_COLOR_BUFFER_BIT);  
+  shUseProgram(_jfaPId);
+  glUniform1i(_jfaU[U_MOBILES], 0);
+  glUniform1i(_jfaU[U_IDS], 1);
+  glUniform2f(_jfaU[U_DIM], _w, _h);
+  shActiveTexture(GL_TEXTURE1);
+  while(n < MAX(_w, _h)) n <<= 1;
+  for(k = n / 2; k >= 1; k /= 2)
+    src = jumpFloodingPass(k, src);
+  /* JFA+1 : une dernière passe de pas 1 */
+  src = jumpFloodingPass(1, src);
+  shBindTexture(GL_TEXTURE_2D, 0);
+  shActiveTexture(GL_TEXTURE0);
+
+  shBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  shViewport(vp[0], vp[1], vp[2], vp[3]);
+  return src;
+}
+
+static void draw(void) {
+  int src = 0;
+  shDisable(GL_DEPTH_TEST);
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_1D, _tId);
   mobileMove();
-  mobile2texture(f);
-  glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA32F, 2 * _nb_mobiles, 0, GL_RGBA, GL_FLOAT, f);
-  free(f);
-  glUniform1i(glGetUniformLocation(_pId, "voronoi"), _voronoi);
-  glUniform1i(glGetUniformLocation(_pId, "mobiles"), 0);
-  glUniform1f(glGetUniformLocation(_pId, "step"), step);
+  jhRun(_nb_mobiles, MOBILE_GRAIN, mobileJob, uhMap(_ring));
+  shActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_BUFFER, uhCommit(_ring));
+  if(_voronoi)
+    src = jumpFlooding();
+
+  shUseProgram(_pId[_voronoi]);
+  glClear(GL_COLOR_BUFFER_BIT);
+  shActiveTexture(GL_TEXTURE1);
+  shBindTexture(GL_TEXTURE_2D, _idTex[src]);
+  glUniform1i(_u[_voronoi][U_MOBILES], 0);
+  glUniform1i(_u[_voronoi][U_IDS], 1);
+  glUniform1i(_u[_voronoi][U_NBALLS], NEYES + 1);
 
   gl4dgDraw(_quad);
   glBindVertexArray(0);
-  glBindTexture(GL_TEXTURE_1D, 0);
-  glUseProgram(0);
+  shBindTexture(GL_TEXTURE_2D, 0);
+  shActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+  shUseProgram(0);
 }
 
 
@@ -238,9 +339,25 @@ static void quit(void) {
     _mobile = NULL;
   }
 
-  if(_tId) {
-    glDeleteTextures(1, &_tId);
-    _tId = 0;
+  if(_ring) {
+    uhDelete(_ring);
+    _ring = NULL;
+    jhClean();
+  }
+
+  if(_idTex[0]) {
+    glDeleteTextures(2, _idTex);
+    _idTex[0] = _idTex[1] = 0;
+  }
+
+  if(_fbo) {
+    glDeleteFramebuffers(1, &_fbo);
+    _fbo = 0;
+  }
+
+  if(_vao) {
+    glDeleteVertexArrays(1, &_vao);
+    _vao = 0;
   }
 
   if(_screen) {
@@ -1,11 +1,16 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <GL4D/gl4du.h>
 #include <GL4D/gl4dh.h>
 #include <GL4D/gl4duw_SDL2.h>
 #include "animations.h"
 #include "audioHelper.h"
+#include "variantHelper.h"
+#include "stateHelper.h"
 
 static void init(void);
+static void loading(void);
+static void draw(void);
 static void quit(void);
 static void resize(int w, int h);
 static void keydown(int keycode);
@@ -29,6 +34,44 @@ static GL4DHanime _animations[] = {
   {    0,   NULL,         NULL,       NULL }
 };
 
+/*!\brief programmes construits par chaque effet ou transition, à
+ * compiler pendant le chargement */
+static struct {
+  void (* effect)(int);
+  void (* transition)(void (*)(int), void (*)(int), Uint32, Uint32, int);
+  const char * vs, * fs, * defines;
+} _programs[] = {
+  { space,      NULL,      "shaders/starfield.vs",   "shaders/starfield.fs",   NULL },
+  { voronoi,    NULL,      "shaders/voronoi.vs",     "shaders/voronoi.fs",     NULL },
+  { voronoi,    NULL,      "shaders/voronoi.vs",     "shaders/voronoi.fs",     "#define VORONOI\n" },
+  { voronoi,    NULL,      "shaders/voronoiSeed.vs", "shaders/voronoiSeed.fs", NULL },
+  { voronoi,    NULL,      "shaders/voronoi.vs",     "shaders/voronoiJFA.fs",  NULL },
+  { stars,      NULL,      "shaders/stars.vs",       "shaders/stars.fs",       NULL },
+  { stars,      NULL,      "shaders/stars.vs",       "shaders/stars.fs",       "#define INSTANCED\n" },
+  { musicBox,   NULL,      "shaders/full.vs",        "shaders/full.fs",        NULL },
+  { musicBox,   NULL,      "shaders/full.vs",        "shaders/full.fs",        "#define INSTANCED\n" },
+  { attraction, NULL,      "shaders/attraction.vs",  "shaders/attraction.fs",  NULL },
+  { attraction, NULL,      "shaders/attraction.vs",  "shaders/attraction.fs",  "#define INSTANCED\n" },
+  { attraction, NULL,      "shaders/post.vs",        "shaders/postSwirl.fs",   NULL },
+  { attraction, NULL,      "shaders/post.vs",        "shaders/postFade.fs",    NULL },
+  { attraction, NULL,      "shaders/post.vs",        "shaders/postBlur.fs",    NULL },
+  { attraction, NULL,      "shaders/post.vs",        "shaders/postCopy.fs",    NULL },
+  { credits,    NULL,      "shaders/credits.vs",     "shaders/credits.fs",     NULL },
+  { NULL,       fondu,     "shaders/basic.vs",       "shaders/mix.fs",         NULL },
+  { NULL,       fondud,    "shaders/basic.vs",       "shaders/mixi.fs",        NULL },
+  { NULL,       fondui,    "shaders/basic.vs",       "shaders/mixi.fs",        NULL },
+  { NULL,       fondu_enc, "shaders/basic.vs",       "shaders/mixi.fs",        NULL },
+  { NULL,       NULL,      NULL,                     NULL,                     NULL }
+};
+
+/*!\brief affiche chaque seconde les compteurs de stateHelper
+ * (touche 's') */
+static int _stats = 0;
+
+/*!\brief nombre de programmes dont la compilation a été lancée au
+ * chargement */
+static int _nbLoading = 0;
+
 static GLfloat _dim[] = {1024, 768};
 
 int main(int argc, char ** argv) {
@@ -41,22 +84,79 @@ int main(int argc, char ** argv) {
   atexit(quit);
   gl4duwResizeFunc(resize);
   gl4duwKeyDownFunc(keydown);
-  gl4duwDisplayFunc(gl4dhDraw);
-
-  ahInitAudio("audio/JPB - High.mp3");
+  gl4duwDisplayFunc(loading);
   gl4duwMainLoop();
   return 0;
 }
 
+/*!\brief lance la compilation de tous les programmes des effets et
+ * transitions de \a _animations ; la démo commence dans loading quand
+ * ils sont prêts. */
 static void init(void) {
+  int i, j;
   glClearColor(0.2f, 0.2f, 0.2f, 0.0f);
-  gl4dhInit(_animations, _dim[0], _dim[1], animationsInit);
+  for(i = 0; _animations[i].first; i++)
+    for(j = 0; _programs[j].vs; j++)
+      if(_programs[j].effect == _animations[i].first ||
+	 (_programs[j].effect && _programs[j].effect == _animations[i].last) ||
+	 (_programs[j].transition && _programs[j].transition == _animations[i].transition))
+	_nbLoading += vhPrepare(_programs[j].vs, _programs[j].fs, _programs[j].defines);
   resize(_dim[0], _dim[1]);
 }
 
+/*!\brief affiche la progression des compilations ; quand il n'en reste
+ * plus, initialise les animations et lance la musique et la démo. */
+static void loading(void) {
+  int n = vhPending();
+  GLint vp[4];
+  glGetIntegerv(GL_VIEWPORT, vp);
+  glClear(GL_COLOR_BUFFER_BIT);
+  /* barre de progression : le plus simple est d'effacer un rectangle */
+  glEnable(GL_SCISSOR_TEST);
+  glScissor(vp[2] / 4, vp[3] / 2 - 4, (vp[2] / 2) * (_nbLoading - n) / MAX(_nbLoading, 1), 8);
+  glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+  glClearColor(0.2f, 0.2f, 0.2f, 0.0f);
+  glDisable(GL_SCISSOR_TEST);
+  if(n)
+    return;
+  gl4dhInit(_animations, _dim[0], _dim[1], animationsInit);
+  gl4duwDisplayFunc(draw);
+  ahInitAudio("audio/JPB - High.mp3");
+}
+
+/*!\brief oublie l'état GL changé par gl4dh depuis la frame
+ * précédente, met à jour le bloc "frame" commun aux shaders puis
+ * dessine les animations. */
+static void draw(void) {
+  static Uint32 t0 = 0;
+  vhFrame_t f;
+  GLint vp[4];
+  shFrame();
+  if(_stats && SDL_GetTicks() - t0 >= 1000) {
+    const shStats_t * st = shStats();
+    fprintf(stderr, "etat GL : %u transmis, %u evites, %u requetes servies, %u envoyees\n",
+	    st->issued, st->saved, st->answered, st->queried);
+    t0 = SDL_GetTicks();
+  }
+  /* viewport de la fenêtre, gl4dh n'a pas encore posé le sien */
+  glGetIntegerv(GL_VIEWPORT, vp);
+  f.resolution[0] = vp[2];
+  f.resolution[1] = vp[3];
+  f.resolution[2] = 1.0f / MAX(vp[2], 1);
+  f.resolution[3] = 1.0f / MAX(vp[3], 1);
+  f.time   = SDL_GetTicks();
+  f.basses = ahGetAudioStreamFreq();
+  f.aigus  = ahGetAudioStreamAigus();
+  f.pad    = 0.0f;
+  vhFrame(&f);
+  gl4dhDraw();
+}
+
 static void resize(int w, int h) {
   _dim[0] = w; _dim[1] = h;
   glViewport(0, 0, _dim[0], _dim[1]);
+  shInvalidate(SH_FRAMEBUFFER_BIT | SH_ATTACHMENT_BIT | SH_VIEWPORT_BIT);
 }
 
 static void keydown(int keycode) {
@@ -64,11 +164,15 @@ static void keydown(int keycode) {
   case SDLK_ESCAPE:
   case 'q':
     exit(0);
+  case 's':
+    _stats = !_stats;
+    break;
   default: break;
   }
 }
 
 static void quit(void) {
   ahClean();
+  vhClean();
   gl4duClean(GL4DU_ALL);
 }
@@ -5,6 +5,8 @@
 #include <SDL_mixer.h>
 #include <GL4D/gl4dh.h>
 #include "audioHelper.h"
+#include "variantHelper.h"
+#include "stateHelper.h"
 
 static void init(int w, int h);
 static void draw(void);
@@ -17,6 +19,10 @@ static int _screen = 0;
 static int _w, _h;
 /*!\brief identifiant du programme GLSL */
 static GLuint _pId = 0;
+/*!\brief emplacements des uniforms du programme */
+enum { U_TIME = 0, U_BASSES, U_SIDE, U_STATE, U_CIRCLE, U_COLOR, U_NB };
+static const char * const _uNames[U_NB] = { "time", "basses", "side", "state", "circle", "color" };
+static GLint _u[U_NB];
 /*!\brief identifiant du quadrilatère de GL4Dummies */
 static GLuint _quad = 0;
 /*!\brief couleur des extremités du cercle */
@@ -36,7 +42,8 @@ static void init(int w, int h) {
   _w = w;
 
   glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-  _pId = gl4duCreateProgram("<vs>shaders/color.vs", "<fs>shaders/color.fs", NULL);
+  _pId = vhProgram("shaders/color.vs", "shaders/color.fs", NULL);
+  vhUniforms(_pId, _uNames, U_NB, _u);
   _quad = gl4dgGenQuadf();
   glBindTexture(GL_TEXTURE_1D, 0);
 }
@@ -68,21 +75,21 @@ static void draw(void) {
   if(_state >= 8 && _basses == 0)
     _state = -1;
 
-  glDisable(GL_DEPTH_TEST);
-  glUseProgram(_pId);
+  shDisable(GL_DEPTH_TEST);
+  shUseProgram(_pId);
 
   glClear(GL_COLOR_BUFFER_BIT);  
-  glUniform1i(glGetUniformLocation(_pId, "time"), t);
-  glUniform1i(glGetUniformLocation(_pId, "basses"), _basses);
-  glUniform1i(glGetUniformLocation(_pId, "side"), _side);
-  glUniform1i(glGetUniformLocation(_pId, "state"), _state);
-  glUniform1i(glGetUniformLocation(_pId, "circle"), _circle);
-  glUniform1fv(glGetUniformLocation(_pId, "color"), 4, _color);
+  glUniform1i(_u[U_TIME], t);
+  glUniform1i(_u[U_BASSES], _basses);
+  glUniform1i(_u[U_SIDE], _side);
+  glUniform1i(_u[U_STATE], _state);
+  glUniform1i(_u[U_CIRCLE], _circle);
+  glUniform1fv(_u[U_COLOR], 4, _color);
 
   gl4dgDraw(_quad);
   glBindVertexArray(0);
   glBindTexture(GL_TEXTURE_1D, 0);
-  glUseProgram(0);
+  shUseProgram(0);
 }
 
 /* !\brief libère les éléments OpenGL utilisés */
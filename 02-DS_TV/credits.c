@@ -6,6 +6,8 @@
 #include <GL4D/gl4dh.h>
 #include <SDL_ttf.h>
 #include "audioHelper.h"
+#include "variantHelper.h"
+#include "stateHelper.h"
 
 static void  init(int w, int h);
 static void  draw(void);
@@ -14,6 +16,10 @@ static void  initText(GLuint * ptId, const char * text);
 
 static int _w, _h;
 static GLuint _pId = 0;
+/*!\brief emplacements des uniforms du programme */
+enum { U_INV = 0, U_TEX, U_NB };
+static const char * const _uNames[U_NB] = { "inv", "tex" };
+static GLint _u[U_NB];
 static int _quad = 0;
 static GLuint _textTexId = 0;
 static GLuint _screen = 0;
@@ -21,7 +27,8 @@ static GLuint _screen = 0;
 static void init(int w, int h) {
   _w = w; _h = h;
   glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-  _pId = gl4duCreateProgram("<vs>shaders/credits.vs", "<fs>shaders/credits.fs", NULL);
+  _pId = vhProgram("shaders/credits.vs", "shaders/credits.fs", NULL);
+  vhUniforms(_pId, _uNames, U_NB, _u);
   gl4duGenMatrix(GL_FLOAT, "modelViewMatrix");
   gl4duGenMatrix(GL_FLOAT, "projectionMatrix");
   _quad = gl4dgGenQuadf();
@@ -43,8 +50,8 @@ static void draw(void) {
   static GLfloat t0 = -1;
   GLfloat t, d;
   GLint vp[4];
-  GLboolean gdt = glIsEnabled(GL_DEPTH_TEST);
-  glGetIntegerv(GL_VIEWPORT, vp);
+  GLboolean gdt = shIsEnabled(GL_DEPTH_TEST);
+  shGetViewport(vp);
   gl4duBindMatrix("projectionMatrix");
   gl4duLoadIdentityf();
   gl4duFrustumf(-0.5, 0.5, -0.5 * vp[3] / vp[2], 0.5 * vp[3] / vp[2], 1.0, 1000.0);
@@ -57,23 +64,23 @@ static void draw(void) {
   t = (SDL_GetTicks() - t0) / 1000.0f, d = -1.1f + 0.25f * t;
   glClearColor(0, 0, 0, 1);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  glEnable(GL_BLEND);
+  shEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  glUseProgram(_pId);
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, _textTexId);
-  glUniform1i(glGetUniformLocation(_pId, "inv"), 1);
-  glUniform1i(glGetUniformLocation(_pId, "tex"), 0);
+  shUseProgram(_pId);
+  shActiveTexture(GL_TEXTURE0);
+  shBindTexture(GL_TEXTURE_2D, _textTexId);
+  glUniform1i(_u[U_INV], 1);
+  glUniform1i(_u[U_TEX], 0);
   gl4duBindMatrix("modelViewMatrix");
   gl4duLoadIdentityf();
   gl4duTranslatef(0, d, -2);
   gl4duScalef(0.5, .5, .5);
   gl4duSendMatrices();
   gl4dgDraw(_quad);
-  glUseProgram(0);
+  shUseProgram(0);
 
   if(!gdt)
-    glDisable(GL_DEPTH_TEST);
+    shDisable(GL_DEPTH_TEST);
 }
 
 static void quit(void) {
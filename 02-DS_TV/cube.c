@@ -1,4 +1,6 @@
 #include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <GL4D/gl4du.h>
 #include <GL4D/gl4duw_SDL2.h>
 #include <GL4D/gl4df.h>
@@ -7,6 +9,9 @@
 #include <SDL_mixer.h>
 #include <GL4D/gl4dh.h>
 #include "audioHelper.h"
+#include "variantHelper.h"
+#include "stateHelper.h"
+#include "meshHelper.h"
 
 #define ECHANTILLONS 1024
 
@@ -14,28 +19,29 @@ static void init(int w, int h);
 static void draw(void);
 static void quit(void);
 
-/* !\brief structure représentant un cube */
-typedef struct cube_t cube_t;
-struct cube_t {
-  float x, y, z;
-  float s;
-  GLfloat c[4];
-};
-
 /* !\brief écran de la démo */
 static int _screen = 0;
 /* !\brief dimensions de la démo */
 static int _w, _h;
 /*!\brief identifiants du programme GLSL */
 static GLuint _pId = 0, _pId2 = 0;
-/*!\brief identifiant du cube de GL4Dummies */
-static GLuint _cube = 0;
-/*!\brief identifiant de la grille de GL4Dummies */
-static GLuint _grid = 0;
-/*!\brief représentation des cubes */
-static cube_t * _cubes = NULL;
-/*!\brief nombre de cubes */
-static int _nbCubes = 0;
+/*!\brief uniforms des cubes et du sol, relevés à l'initialisation (le
+ * temps vient du bloc "frame") */
+enum { U_ID = 0, U_MOVE, U_BASSES, U_LUMPOS, U_NBCUBES, U_SPREAD, U_NB };
+static const char * const _uNames[U_NB] = { "id", "move", "basses", "lumPos", "nbCubes", "spread" };
+static GLint _u[U_NB];
+enum { US_TEX = 0, US_STEP, US_AMPLITUDE, US_NB };
+static const char * const _usNames[US_NB] = { "tex", "step", "amplitude" };
+static GLint _us[US_NB];
+/*!\brief VAO du cube, dessiné en instances, et ses buffers */
+static GLuint _cubeVAO = 0, _cubeBuffers[2] = {0};
+/*!\brief VAO de la grille du sol, ses buffers et son nombre
+ * d'indices */
+static GLuint _gridVAO = 0, _gridBuffers[2] = {0};
+static GLsizei _gridIndices = 0;
+/*!\brief nombre de cubes de l'anneau ; leur placement est calculé
+ * dans cube.vs, le coût CPU ne dépend donc pas de ce nombre */
+static int _nbCubes = ECHANTILLONS;
 /*!\brief dimensions de la grille */
 static int _gridWidth = 255, _gridHeight = 255;
 /*!\brief coordonnées de la lumière */
@@ -47,38 +53,109 @@ static GLuint _move = 0;
 /*!\brief état de la démo */
 static int _state = 0;
 
+/*!\brief construit le VAO d'un cube [-1, 1]^3 (comme
+ * gl4dgGenCubef), 4 sommets et une normale par face, pour le dessin
+ * instancié */
+static void cubeInit(void) {
+  /* normale puis deux axes de chaque face, tels que u x v = n */
+  static const GLfloat faces[6][3][3] = {
+    { { 1,  0,  0}, {0, 1, 0}, {0, 0, 1} },
+    { {-1,  0,  0}, {0, 0, 1}, {0, 1, 0} },
+    { { 0,  1,  0}, {0, 0, 1}, {1, 0, 0} },
+    { { 0, -1,  0}, {1, 0, 0}, {0, 0, 1} },
+    { { 0,  0,  1}, {1, 0, 0}, {0, 1, 0} },
+    { { 0,  0, -1}, {0, 1, 0}, {1, 0, 0} }
+  };
+  static const GLfloat st[4][2] = { {-1, -1}, {1, -1}, {1, 1}, {-1, 1} };
+  GLfloat data[6 * 4 * 8], * d = data;
+  GLuint index[6 * 6], * e = index;
+  int f, k, j;
+  for(f = 0; f < 6; f++, e += 6) {
+    for(k = 0; k < 4; k++, d += 8) {
+      for(j = 0; j < 3; j++) {
+        d[j] = faces[f][0][j] + st[k][0] * faces[f][1][j] + st[k][1] * faces[f][2][j];
+        d[3 + j] = faces[f][0][j];
+      }
+      d[6] = (st[k][0] + 1.0f) / 2.0f;
+      d[7] = (st[k][1] + 1.0f) / 2.0f;
+    }
+    e[0] = 4 * f; e[1] = 4 * f + 1; e[2] = 4 * f + 2;
+    e[3] = 4 * f; e[4] = 4 * f + 2; e[5] = 4 * f + 3;
+  }
+  glGenVertexArrays(1, &_cubeVAO);
+  glGenBuffers(2, _cubeBuffers);
+  glBindVertexArray(_cubeVAO);
+  glBindBuffer(GL_ARRAY_BUFFER, _cubeBuffers[0]);
+  glBufferData(GL_ARRAY_BUFFER, sizeof data, data, GL_STATIC_DRAW);
+  glEnableVertexAttribArray(0);
+  glEnableVertexAttribArray(1);
+  glEnableVertexAttribArray(2);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof *data, (const void *)0);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof *data, (const void *)(3 * sizeof *data));
+  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof *data, (const void *)(6 * sizeof *data));
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _cubeBuffers[1]);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof index, index, GL_STATIC_DRAW);
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/*!\brief construit le VAO de la grille [-1, 1]^2 du plan y = 0, de
+ * _gridWidth x _gridHeight sommets (positions seules, sol.vs calcule
+ * hauteur et normale), indices optimisés pour le cache de sommets */
+static void gridInit(void) {
+  int i, j, n = _gridWidth, nv = _gridWidth * _gridHeight;
+  GLfloat * data = malloc(3 * nv * sizeof *data), * d = data, acmr;
+  GLuint * index, * e;
+  _gridIndices = 6 * (_gridWidth - 1) * (_gridHeight - 1);
+  e = index = malloc(_gridIndices * sizeof *index);
+  assert(data && index);
+  for(j = 0; j < _gridHeight; j++)
+    for(i = 0; i < _gridWidth; i++, d += 3) {
+      d[0] = -1.0f + 2.0f * i / (_gridWidth - 1);
+      d[1] = 0.0f;
+      d[2] = -1.0f + 2.0f * j / (_gridHeight - 1);
+    }
+  /* deux triangles par case, dans le sens direct vus depuis +y */
+  for(j = 0; j < _gridHeight - 1; j++)
+    for(i = 0; i < _gridWidth - 1; i++, e += 6) {
+      GLuint k = j * n + i;
+      e[0] = k;     e[1] = k + n; e[2] = k + 1;
+      e[3] = k + 1; e[4] = k + n; e[5] = k + n + 1;
+    }
+  acmr = mhACMR(index, _gridIndices, nv);
+  mhOptimize(index, _gridIndices, nv);
+  mhReorderVertices(index, _gridIndices, data, 3 * sizeof *data, nv);
+  fprintf(stderr, "cube : grille %dx%d, ACMR %.3f -> %.3f\n", _gridWidth, _gridHeight, acmr, mhACMR(index, _gridIndices, nv));
+  glGenVertexArrays(1, &_gridVAO);
+  glGenBuffers(2, _gridBuffers);
+  glBindVertexArray(_gridVAO);
+  glBindBuffer(GL_ARRAY_BUFFER, _gridBuffers[0]);
+  glBufferData(GL_ARRAY_BUFFER, 3 * nv * sizeof *data, data, GL_STATIC_DRAW);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof *data, (const void *)0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _gridBuffers[1]);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, _gridIndices * sizeof *index, index, GL_STATIC_DRAW);
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  free(data);
+  free(index);
+}
+
 /*!\brief initialise les paramètres OpenGL et les données */
 static void init(int w, int h) {
   _w = w;
   _h = h;
   glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-  _pId  = gl4duCreateProgram("<vs>shaders/cube.vs", "<fs>shaders/cube.fs", NULL);
-  _pId2 = gl4duCreateProgram("<vs>shaders/sol.vs", "<fs>shaders/sol.fs", NULL);
+  _pId  = vhProgram("shaders/cube.vs", "shaders/cube.fs", NULL);
+  _pId2 = vhProgram("shaders/sol.vs", "shaders/sol.fs", NULL);
+  vhUniforms(_pId, _uNames, U_NB, _u);
+  vhUniforms(_pId2, _usNames, US_NB, _us);
   gl4duGenMatrix(GL_FLOAT, "modelViewMatrix");
   gl4duGenMatrix(GL_FLOAT, "projectionMatrix");
-  _cube = gl4dgGenCubef();
-  _grid = gl4dgGenGrid2df(_gridWidth, _gridHeight);
-
-  double i;
-  int it = 0;
-  /* calcul du nombre de cubes */
-  for(i = 0; i < 2 * M_PI; i += 2 * M_PI / ECHANTILLONS)
-    _nbCubes++;
-  _cubes = malloc(_nbCubes * sizeof *_cubes);
-
-  /* initialisation des données des cubes */
-  for(i = 0; i < 2 * M_PI; i += 2 * M_PI / ECHANTILLONS) {
-    _cubes[it].x = cos(i);
-    _cubes[it].y = sin(i);
-    _cubes[it].z = (gl4dmURand() * 8.0 + 8.0) * -1.0 + 3.0;
-    GLfloat c = gl4dmURand();
-    _cubes[it].c[0] = c > 0.5 ? 1.0 : 0.0;
-    _cubes[it].c[1] = c > 0.5 ? 0.0 : 0.0;
-    _cubes[it].c[2] = c > 0.5 ? 1.0 : 1.0;
-    _cubes[it].c[3] = 1.0;
-    _cubes[it].s = (gl4dmURand() * 1.0) * 0.05;
-    it++;
-  }
+  if(!_cubeVAO)
+    cubeInit();
+  if(!_gridVAO)
+    gridInit();
 }
 
 /*!\brief dessine dans le contexte OpenGL actif. */
@@ -86,55 +163,44 @@ static void draw(void) {
   static Uint32 t0 = 0;
   static double a = 0.0;
   static int prev_moy = 0;
-  double i; 
-  int it = 0;
+  int i;
   GLfloat dt = 0.0;
-  GLfloat steps2[2] = { 2.0 / _gridWidth, 2.0 / _gridHeight};
+  GLfloat steps2[2] = { 2.0 / (_gridWidth - 1), 2.0 / (_gridHeight - 1)};
   GLfloat lumPos[4], *mat;
   Uint32 t;
   dt = ((t = SDL_GetTicks()) - t0) / 1000.0;
   t0 = t;
   GLint vp[4];
-  glGetIntegerv(GL_VIEWPORT, vp);
+  shGetViewport(vp);
   gl4duBindMatrix("projectionMatrix");
   gl4duLoadIdentityf();
   gl4duFrustumf(-0.5, 0.5, -0.5 * vp[3] / vp[2], 0.5 * vp[3] / vp[2], 1.0, 1000.0);
 
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  glEnable(GL_CULL_FACE);
-  glEnable(GL_DEPTH_TEST);
-  glDisable(GL_BLEND);
+  shEnable(GL_CULL_FACE);
+  shEnable(GL_DEPTH_TEST);
+  shDisable(GL_BLEND);
   gl4duBindMatrix("modelViewMatrix");
   gl4duLoadIdentityf();
   mat = gl4duGetMatrixData();
   MMAT4XVEC4(lumPos, mat, _lumPos0);
-  glUseProgram(_pId);
+  shUseProgram(_pId);
 
-  /* dessine les cubes */
-  for(i = 0; i < 2 * M_PI; i += 2 * M_PI / ECHANTILLONS) {
-    gl4duPushMatrix(); {
-      GLfloat x = _cubes[it].x;
-      GLfloat y = _cubes[it].y;
-      if(_state) {
-        x *= _moyenne * 0.0001;
-        y *= _moyenne * 0.0001;
-      }
-      gl4duTranslatef(x, y, _cubes[it].z);
-      gl4duRotatef(0, 0, 0, 0);
-      gl4duScalef(_cubes[it].s,_cubes[it].s, _cubes[it].s);
-      glUniform1i(glGetUniformLocation(_pId, "id"), 2);
-      glUniform1i(glGetUniformLocation(_pId, "move"), _move);
-      glUniform1i(glGetUniformLocation(_pId, "basses"), _moyenne/1000);
-      glUniform1i(glGetUniformLocation(_pId, "time"), SDL_GetTicks());
-      glUniform4fv(glGetUniformLocation(_pId, "lumPos"), 1, lumPos);
-      gl4duSendMatrices();
-    } gl4duPopMatrix();
-    gl4dgDraw(_cube);
-    it++;
-  }
+  /* dessine l'anneau de cubes en un seul appel : cube.vs place
+   * chaque instance d'après gl_InstanceID */
+  glUniform1i(_u[U_ID], 2);
+  glUniform1i(_u[U_MOVE], _move);
+  glUniform1i(_u[U_BASSES], _moyenne/1000);
+  glUniform4fv(_u[U_LUMPOS], 1, lumPos);
+  glUniform1i(_u[U_NBCUBES], _nbCubes);
+  glUniform1f(_u[U_SPREAD], _state ? _moyenne * 0.0001 : 1.0);
+  gl4duSendMatrices();
+  glBindVertexArray(_cubeVAO);
+  glDrawElementsInstanced(GL_TRIANGLES, 36, GL_UNSIGNED_INT, (const void *)0, _nbCubes);
+  glBindVertexArray(0);
 
-  glActiveTexture(GL_TEXTURE0);
-  glUseProgram(_pId2);
+  shActiveTexture(GL_TEXTURE0);
+  shUseProgram(_pId2);
   gl4duLoadIdentityf();
   /* dessine les grilles */
   for(i = 0; i < 2; i++) {
@@ -142,13 +208,14 @@ static void draw(void) {
       gl4duTranslatef(0, i ? -1 : 1, -3);
       gl4duScalef(1, 1, 0.5);
       if(!i) gl4duRotatef(180, 270, 0, 0);
-      glUniform1i(glGetUniformLocation(_pId2, "tex"), 0);
-      glUniform1ui(glGetUniformLocation(_pId2, "frame"), SDL_GetTicks());
-      glUniform2fv(glGetUniformLocation(_pId2, "step"), 1, steps2);
-      glUniform1f(glGetUniformLocation(_pId2, "amplitude"), _moyenne / ((1 << 15) + 1.0));
+      glUniform1i(_us[US_TEX], 0);
+      glUniform2fv(_us[US_STEP], 1, steps2);
+      glUniform1f(_us[US_AMPLITUDE], _moyenne / ((1 << 15) + 1.0));
       gl4duSendMatrices();
     } gl4duPopMatrix();
-    gl4dgDraw(_grid);
+    glBindVertexArray(_gridVAO);
+    glDrawElements(GL_TRIANGLES, _gridIndices, GL_UNSIGNED_INT, (const void *)0);
+    glBindVertexArray(0);
   }
 
   /* modifie la coordonnée Y de la lumière */
@@ -175,6 +242,16 @@ static void draw(void) {
 
 /* !\brief libère les éléments OpenGL utilisés */
 static void quit(void) {
+  if(_cubeVAO) {
+    glDeleteVertexArrays(1, &_cubeVAO);
+    glDeleteBuffers(2, _cubeBuffers);
+    _cubeVAO = 0;
+  }
+  if(_gridVAO) {
+    glDeleteVertexArrays(1, &_gridVAO);
+    glDeleteBuffers(2, _gridBuffers);
+    _gridVAO = 0;
+  }
   if(_screen) {
     gl4dpSetScreen(_screen);
     gl4dpDeleteScreen();
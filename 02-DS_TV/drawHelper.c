@@ -0,0 +1,143 @@
+#include "drawHelper.h"
+#include <math.h>
+
+/*!\brief demi-largeur de la rampe d'anti-crénelage (en pixels) */
+#define AA_HALF 0.5f
+
+static int  capsuleSpan(float ax, float ay, float bx, float by, float r, float y, float * l, float * h);
+static void capsule(float ax, float ay, float bx, float by, float r);
+
+/*!\brief mélange la couleur \a c dans le pixel \a p selon la
+ * couverture \a a (0 à 256).
+ */
+static inline void blendPixel(GLuint * p, GLuint c, int a) {
+  GLuint d = *p;
+  int r = RED(d), g = GREEN(d), b = BLUE(d);
+  r += ((((int)RED(c))   - r) * a) >> 8;
+  g += ((((int)GREEN(c)) - g) * a) >> 8;
+  b += ((((int)BLUE(c))  - b) * a) >> 8;
+  *p = RGB(r, g, b);
+}
+
+/*!\brief réduit l'intervalle [\a l, \a h] aux \a x tels que \a a * x
+ * + \a b soit dans [\a lo, \a hi].
+ * \return 0 si l'intervalle devient vide, 1 sinon.
+ */
+static inline int clipLinear(float a, float b, float lo, float hi, float * l, float * h) {
+  float x0, x1;
+  if(fabsf(a) < 1e-6f)
+    return b >= lo && b <= hi;
+  x0 = (lo - b) / a;
+  x1 = (hi - b) / a;
+  if(x0 > x1) { float tmp = x0; x0 = x1; x1 = tmp; }
+  if(x0 > *l) *l = x0;
+  if(x1 < *h) *h = x1;
+  return *l <= *h;
+}
+
+/*!\brief calcule l'intervalle [\a l, \a h] couvert sur la ligne \a y
+ * par la capsule de rayon \a r autour du segment (\a ax, \a ay) -
+ * (\a bx, \a by). La capsule étant convexe, cet intervalle est
+ * l'union des intervalles des deux disques extrémités et du
+ * rectangle central.
+ * \return 0 si la ligne ne coupe pas la capsule, 1 sinon.
+ */
+static int capsuleSpan(float ax, float ay, float bx, float by, float r, float y, float * l, float * h) {
+  int found = 0;
+  float dx = bx - ax, dy = by - ay, len = sqrtf(dx * dx + dy * dy), e;
+  *l = INFINITY; *h = -INFINITY;
+  /* les deux disques */
+  if((e = r * r - (y - ay) * (y - ay)) >= 0.0f) {
+    e = sqrtf(e);
+    *l = ax - e; *h = ax + e;
+    found = 1;
+  }
+  if((e = r * r - (y - by) * (y - by)) >= 0.0f) {
+    e = sqrtf(e);
+    if(bx - e < *l) *l = bx - e;
+    if(bx + e > *h) *h = bx + e;
+    found = 1;
+  }
+  /* le rectangle */
+  if(len > 1e-6f) {
+    float ux = dx / len, uy = dy / len, rl = -INFINITY, rh = INFINITY;
+    if(clipLinear(ux, (y - ay) * uy - ax * ux, 0.0f, len, &rl, &rh) &&
+       clipLinear(-uy, (y - ay) * ux + ax * uy, -r, r, &rl, &rh)) {
+      if(rl < *l) *l = rl;
+      if(rh > *h) *h = rh;
+      found = 1;
+    }
+  }
+  return found;
+}
+
+/*!\brief distance du point (\a px, \a py) au segment (\a ax, \a ay) -
+ * (\a bx, \a by).
+ */
+static inline float segmentDistance(float px, float py, float ax, float ay, float bx, float by) {
+  float dx = bx - ax, dy = by - ay, l2 = dx * dx + dy * dy, s = 0.0f;
+  if(l2 > 1e-12f) {
+    s = ((px - ax) * dx + (py - ay) * dy) / l2;
+    s = s < 0.0f ? 0.0f : (s > 1.0f ? 1.0f : s);
+  }
+  dx = px - (ax + s * dx);
+  dy = py - (ay + s * dy);
+  return sqrtf(dx * dx + dy * dy);
+}
+
+/*!\brief rasterise par lignes de balayage la capsule de rayon \a r
+ * autour du segment (\a ax, \a ay) - (\a bx, \a by) dans l'écran
+ * courant avec la couleur courante. L'intérieur (à plus d'un
+ * demi-pixel du bord) est rempli par span, seule la bordure calcule
+ * une couverture ; le coût est donc proportionnel au nombre de pixels
+ * couverts.
+ */
+static void capsule(float ax, float ay, float bx, float by, float r) {
+  int x, y, y0, y1, w = gl4dpGetWidth(), h = gl4dpGetHeight();
+  float ro = r + AA_HALF, ri = r - AA_HALF;
+  GLuint c = gl4dpGetColor(), * pixels = gl4dpGetPixels();
+  y0 = (int)ceilf(MIN(ay, by) - ro);
+  y1 = (int)floorf(MAX(ay, by) + ro);
+  if(y0 < 0) y0 = 0;
+  if(y1 > h - 1) y1 = h - 1;
+  for(y = y0; y <= y1; y++) {
+    float ol, oh, il, ih;
+    int xs, xe, is, ie;
+    GLuint * row = &pixels[y * w];
+    if(!capsuleSpan(ax, ay, bx, by, ro, y, &ol, &oh))
+      continue;
+    xs = (int)ceilf(ol);  if(xs < 0) xs = 0;
+    xe = (int)floorf(oh); if(xe > w - 1) xe = w - 1;
+    if(ri > 0.0f && capsuleSpan(ax, ay, bx, by, ri, y, &il, &ih)) {
+      is = (int)ceilf(il);  if(is < xs) is = xs;
+      ie = (int)floorf(ih); if(ie > xe) ie = xe;
+    } else {
+      is = xe + 1; ie = xe;
+    }
+    /* bordure gauche, intérieur plein, bordure droite */
+    for(x = xs; x < is; x++) {
+      float a = r + AA_HALF - segmentDistance(x, y, ax, ay, bx, by);
+      if(a > 0.0f) blendPixel(&row[x], c, a >= 1.0f ? 256 : (int)(a * 256.0f));
+    }
+    for(; x <= ie; x++)
+      row[x] = c;
+    for(; x <= xe; x++) {
+      float a = r + AA_HALF - segmentDistance(x, y, ax, ay, bx, by);
+      if(a > 0.0f) blendPixel(&row[x], c, a >= 1.0f ? 256 : (int)(a * 256.0f));
+    }
+  }
+}
+
+/*!\brief dessine un segment anti-crénelé d'épaisseur \a t (en pixels)
+ * avec la couleur courante de l'écran courant.
+ */
+void dhLine(float x0, float y0, float x1, float y1, float t) {
+  capsule(x0, y0, x1, y1, 0.5f * MAX(t, 1.0f));
+}
+
+/*!\brief dessine un point anti-crénelé (disque) de diamètre \a t (en
+ * pixels) avec la couleur courante de l'écran courant.
+ */
+void dhPoint(float x, float y, float t) {
+  capsule(x, y, x, y, 0.5f * MAX(t, 1.0f));
+}
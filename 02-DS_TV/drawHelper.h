@@ -0,0 +1,18 @@
+#ifndef _DRAW_HELPER_H
+
+#define _DRAW_HELPER_H
+
+#include <GL4D/gl4dp.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  extern void dhLine(float x0, float y0, float x1, float y1, float t);
+  extern void dhPoint(float x, float y, float t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,308 @@
+#include "lodHelper.h"
+#include "stateHelper.h"
+#include "meshHelper.h"
+#include <SDL_image.h>
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*!\brief nombre de niveaux de détail des sphères */
+#define LH_LEVELS 4
+/*!\brief nombre de flottants par instance : centre et rayon, couleur
+ * puis couche de la texture tableau */
+#define LH_STRIDE 9
+
+/*!\brief maillage indexé : VAO, sommets, indices et nombre d'indices */
+typedef struct lhMesh_t lhMesh_t;
+struct lhMesh_t {
+  GLuint vao, buffer[2];
+  GLsizei count;
+};
+
+/*!\brief sommet compacté : position, normale en 10-10-10-2 et
+ * coordonnées de texture en demi-flottants (20 octets au lieu de 32) */
+typedef struct lhVertex_t lhVertex_t;
+struct lhVertex_t {
+  GLfloat position[3];
+  GLuint normal;
+  GLushort texCoord[2];
+};
+
+/*!\brief longitudes (et latitudes) de chaque niveau */
+static const GLuint _slices[LH_LEVELS] = { 64, 32, 16, 8 };
+/*!\brief rayon à l'écran (en pixels) à partir duquel chaque niveau est
+ * utilisé ; en dessous du dernier, la sphère devient un imposteur */
+static const GLfloat _minRadius[LH_LEVELS] = { 32.0f, 16.0f, 8.0f, 3.0f };
+/*!\brief sphères de chaque niveau puis quadrilatère des imposteurs */
+static lhMesh_t _mesh[LH_LEVELS + 1];
+/*!\brief buffer des instances, partagé par tous les maillages */
+static GLuint _instBuffer = 0;
+/*!\brief instances ajoutées depuis le dernier lhDraw, puis les mêmes
+ * rangées par niveau */
+static GLfloat * _inst = NULL, * _sorted = NULL;
+static int _nbInst = 0, _sizeInst = 0;
+/*!\brief nombre d'effets utilisant les sphères */
+static int _users = 0;
+/*!\brief pixels par unité de rayon à distance 1 de la caméra */
+static GLfloat _pixelScale = 1.0f;
+
+/*!\brief fait pointer les attributs 3 (centre et rayon), 4 (couleur)
+ * et 5 (couche) du VAO lié sur les instances à partir de \a first. */
+static void instanceAttribs(GLint first) {
+  const GLsizei stride = LH_STRIDE * sizeof(GLfloat);
+  size_t base = first * stride;
+  glBindBuffer(GL_ARRAY_BUFFER, _instBuffer);
+  glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (const void *)base);
+  glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, (const void *)(base + 4 * sizeof(GLfloat)));
+  glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, stride, (const void *)(base + 8 * sizeof(GLfloat)));
+}
+
+/*!\brief compacte dans \a v le sommet \a f (position, normale et
+ * coordonnées de texture). */
+static void pack(lhVertex_t * v, const GLfloat * f) {
+  memcpy(v->position, f, sizeof v->position);
+  v->normal = mhPackNormal(f[3], f[4], f[5]);
+  v->texCoord[0] = mhHalf(f[6]);
+  v->texCoord[1] = mhHalf(f[7]);
+}
+
+/*!\brief crée le VAO d'un maillage dont les sommets compactés donnent
+ * position, normale et coordonnées de texture (attributs 0, 1 et 2,
+ * comme les géométries GL4Dummies), les attributs 3 à 5 avançant par
+ * instance. */
+static void meshInit(lhMesh_t * mesh, const lhVertex_t * data, GLsizei nv, const GLuint * index, GLsizei ni) {
+  int i;
+  glGenVertexArrays(1, &mesh->vao);
+  glGenBuffers(2, mesh->buffer);
+  glBindVertexArray(mesh->vao);
+  glBindBuffer(GL_ARRAY_BUFFER, mesh->buffer[0]);
+  glBufferData(GL_ARRAY_BUFFER, nv * sizeof *data, data, GL_STATIC_DRAW);
+  for(i = 0; i < 3; i++)
+    glEnableVertexAttribArray(i);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof *data, (const void *)offsetof(lhVertex_t, position));
+  glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof *data, (const void *)offsetof(lhVertex_t, normal));
+  glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof *data, (const void *)offsetof(lhVertex_t, texCoord));
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->buffer[1]);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, ni * sizeof *index, index, GL_STATIC_DRAW);
+  for(i = 3; i < 6; i++) {
+    glEnableVertexAttribArray(i);
+    glVertexAttribDivisor(i, 1);
+  }
+  instanceAttribs(0);
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  mesh->count = ni;
+}
+
+/*!\brief sphère unité de \a slices longitudes et latitudes, paramétrée
+ * comme gl4dgGenSpheref, ses triangles puis ses sommets réordonnés pour
+ * le cache de sommets (voir meshHelper). */
+static void sphereInit(lhMesh_t * mesh, GLuint slices) {
+  GLuint i, j, k, n = slices + 1, ni = slices * slices * 6;
+  GLfloat phi, theta, d[8], acmr;
+  lhVertex_t * data, * v;
+  GLuint * index, * e;
+  v = data = malloc(n * n * sizeof *data);
+  e = index = malloc(ni * sizeof *index);
+  assert(data && index);
+  for(i = 0; i <= slices; i++) {
+    phi = -M_PI / 2.0 + i * M_PI / slices;
+    for(j = 0; j <= slices; j++, v++) {
+      theta = j * 2.0 * M_PI / slices;
+      /* sur la sphère unité, la normale est la position */
+      d[0] = d[3] = cos(phi) * cos(theta);
+      d[1] = d[4] = sin(phi);
+      d[2] = d[5] = -cos(phi) * sin(theta);
+      d[6] = j / (GLfloat)slices;
+      d[7] = i / (GLfloat)slices;
+      pack(v, d);
+    }
+  }
+  for(i = 0; i < slices; i++)
+    for(j = 0; j < slices; j++, e += 6) {
+      k = i * n + j;
+      e[0] = k;     e[1] = k + 1;     e[2] = k + n;
+      e[3] = k + 1; e[4] = k + n + 1; e[5] = k + n;
+    }
+  acmr = mhACMR(index, ni, n * n);
+  mhOptimize(index, ni, n * n);
+  mhReorderVertices(index, ni, data, sizeof *data, n * n);
+  fprintf(stderr, "lodHelper : sphere %ux%u, ACMR %.3f -> %.3f\n", slices, slices, acmr, mhACMR(index, ni, n * n));
+  meshInit(mesh, data, n * n, index, ni);
+  free(data);
+  free(index);
+}
+
+/*!\brief quadrilatère [-1, 1]² des imposteurs, comme gl4dgGenQuadf. */
+static void quadInit(lhMesh_t * mesh) {
+  static const GLfloat f[] = {
+    -1, -1, 0,  0, 0, 1,  0, 0,
+     1, -1, 0,  0, 0, 1,  1, 0,
+     1,  1, 0,  0, 0, 1,  1, 1,
+    -1,  1, 0,  0, 0, 1,  0, 1
+  };
+  static const GLuint index[] = { 0, 1, 2, 0, 2, 3 };
+  lhVertex_t data[4];
+  int i;
+  for(i = 0; i < 4; i++)
+    pack(&data[i], &f[8 * i]);
+  meshInit(mesh, data, 4, index, 6);
+}
+
+/*!\brief construit, au premier appel, la chaîne de sphères, le
+ * quadrilatère des imposteurs et le buffer des instances. Chaque appel
+ * doit être suivi d'un lhClean. */
+void lhInit(void) {
+  int i;
+  if(_users++) return;
+  glGenBuffers(1, &_instBuffer);
+  for(i = 0; i < LH_LEVELS; i++)
+    sphereInit(&_mesh[i], _slices[i]);
+  quadInit(&_mesh[LH_LEVELS]);
+}
+
+/*!\brief à appeler une fois par frame, une fois la matrice de
+ * projection posée : relève l'échelle de projection et la hauteur de
+ * la vue, puis lie de nouveau "modelViewMatrix". */
+void lhBegin(void) {
+  GLint vp[4];
+  GLfloat * p;
+  shGetViewport(vp);
+  gl4duBindMatrix("projectionMatrix");
+  p = gl4duGetMatrixData();
+  /* élément (1, 1), identique en ligne ou en colonne */
+  _pixelScale = p[5] * vp[3] / 2.0f;
+  gl4duBindMatrix("modelViewMatrix");
+}
+
+/*!\brief ajoute au prochain lhDraw une sphère de centre (\a x, \a y,
+ * \a z) et de rayon \a r, exprimés dans le repère de la matrice
+ * "modelViewMatrix" de ce lhDraw. La couleur \a color (blanc si NULL)
+ * multiplie la couche \a layer de la texture tableau. */
+void lhAdd(GLfloat x, GLfloat y, GLfloat z, GLfloat r, const GLfloat * color, GLfloat layer) {
+  static const GLfloat white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+  GLfloat * p;
+  if(_nbInst == _sizeInst) {
+    _sizeInst = _sizeInst ? 2 * _sizeInst : 256;
+    _inst = realloc(_inst, _sizeInst * LH_STRIDE * sizeof *_inst);
+    _sorted = realloc(_sorted, _sizeInst * LH_STRIDE * sizeof *_sorted);
+    assert(_inst && _sorted);
+  }
+  if(!color) color = white;
+  p = &_inst[_nbInst++ * LH_STRIDE];
+  p[0] = x; p[1] = y; p[2] = z; p[3] = r;
+  memcpy(&p[4], color, 4 * sizeof *p);
+  p[8] = layer;
+}
+
+/*!\brief niveau de l'instance \a p selon son rayon à l'écran ; \a m
+ * est la matrice "modelViewMatrix" et \a s son échelle. */
+static int level(const GLfloat * m, GLfloat s, const GLfloat * p) {
+  int i;
+  /* matrices GL4Dummies rangées par lignes : la profondeur est la
+   * troisième ligne appliquée au centre */
+  GLfloat z = -(m[8] * p[0] + m[9] * p[1] + m[10] * p[2] + m[11]);
+  GLfloat px = z > 0.0f ? p[3] * s * _pixelScale / z : 0.0f;
+  for(i = 0; i < LH_LEVELS; i++)
+    if(px >= _minRadius[i])
+      return i;
+  return LH_LEVELS;
+}
+
+/*!\brief dessine toutes les sphères ajoutées par lhAdd depuis le
+ * dernier appel, placées par la matrice "modelViewMatrix" courante
+ * (déjà envoyée au programme utilisé). Les instances sont rangées par
+ * niveau de détail puis envoyées en une fois ; chaque niveau non vide
+ * est un seul glDrawElementsInstanced, les plus petites devenant des
+ * quadrilatères face à la caméra (\a impostor est l'emplacement de
+ * l'uniform "impostor" du programme).
+ * \return le nombre d'appels de dessin.
+ */
+int lhDraw(GLint impostor) {
+  int i, l, draws = 0, first[LH_LEVELS + 2] = { 0 }, next[LH_LEVELS + 1];
+  /* première colonne (échelle en x) en 0, 4, 8 */
+  const GLfloat * m = gl4duGetMatrixData();
+  GLfloat s = sqrtf(m[0] * m[0] + m[4] * m[4] + m[8] * m[8]);
+  if(!_nbInst) return 0;
+  /* tri par dénombrement */
+  for(i = 0; i < _nbInst; i++)
+    first[level(m, s, &_inst[i * LH_STRIDE]) + 1]++;
+  for(l = 0; l <= LH_LEVELS; l++) {
+    first[l + 1] += first[l];
+    next[l] = first[l];
+  }
+  for(i = 0; i < _nbInst; i++) {
+    l = level(m, s, &_inst[i * LH_STRIDE]);
+    memcpy(&_sorted[next[l]++ * LH_STRIDE], &_inst[i * LH_STRIDE], LH_STRIDE * sizeof *_sorted);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, _instBuffer);
+  glBufferData(GL_ARRAY_BUFFER, _nbInst * LH_STRIDE * sizeof *_sorted, _sorted, GL_STREAM_DRAW);
+  for(l = 0; l <= LH_LEVELS; l++) {
+    if(first[l + 1] == first[l]) continue;
+    glBindVertexArray(_mesh[l].vao);
+    instanceAttribs(first[l]);
+    if(l == LH_LEVELS)
+      glUniform1i(impostor, 1);
+    glDrawElementsInstanced(GL_TRIANGLES, _mesh[l].count, GL_UNSIGNED_INT, (const void *)0, first[l + 1] - first[l]);
+    if(l == LH_LEVELS)
+      glUniform1i(impostor, 0);
+    draws++;
+  }
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  _nbInst = 0;
+  return draws;
+}
+
+/*!\brief charge les \a n images \a files, mises à l'échelle \a w x \a
+ * h, dans les couches d'une texture GL_TEXTURE_2D_ARRAY (avec
+ * mipmaps, les sphères étant souvent petites à l'écran).
+ * \return l'identifiant de la texture.
+ */
+GLuint lhTexArray(const char ** files, int n, int w, int h) {
+  int i;
+  GLuint tId;
+  SDL_Surface * t, * s = SDL_CreateRGBSurface(0, w, h, 32, R_MASK, G_MASK, B_MASK, A_MASK);
+  assert(s);
+  glGenTextures(1, &tId);
+  shBindTexture(GL_TEXTURE_2D_ARRAY, tId);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, w, h, n, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+  for(i = 0; i < n; i++) {
+    if( (t = IMG_Load(files[i])) != NULL ) {
+      /* recopie sans mélange, convertie en RGBA */
+      SDL_SetSurfaceBlendMode(t, SDL_BLENDMODE_NONE);
+      SDL_BlitScaled(t, NULL, s, NULL);
+      SDL_FreeSurface(t);
+    } else {
+      fprintf(stderr, "can't open file %s : %s\n", files[i], SDL_GetError());
+      SDL_FillRect(s, NULL, 0);
+    }
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, w, h, 1, GL_RGBA, GL_UNSIGNED_BYTE, s->pixels);
+  }
+  glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+  shBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  SDL_FreeSurface(s);
+  return tId;
+}
+
+/*!\brief libère les sphères quand plus aucun effet ne les utilise. */
+void lhClean(void) {
+  int i;
+  if(!_users || --_users) return;
+  for(i = 0; i <= LH_LEVELS; i++) {
+    glDeleteVertexArrays(1, &_mesh[i].vao);
+    glDeleteBuffers(2, _mesh[i].buffer);
+    memset(&_mesh[i], 0, sizeof _mesh[i]);
+  }
+  glDeleteBuffers(1, &_instBuffer);
+  _instBuffer = 0;
+  free(_inst);
+  free(_sorted);
+  _inst = _sorted = NULL;
+  _nbInst = _sizeInst = 0;
+}
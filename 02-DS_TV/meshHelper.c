@@ -0,0 +1,190 @@
+#include "meshHelper.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*!\brief taille du cache de sommets visé par mhOptimize */
+#define MH_CACHE 32
+/*!\brief taille du cache FIFO simulé par mhACMR, de l'ordre de celui
+ * des GPU */
+#define MH_FIFO 16
+
+/*!\brief score d'un sommet (Forsyth, "Linear-Speed Vertex Cache
+ * Optimisation") : favorise les sommets récents dans le cache et ceux
+ * qui n'ont plus que peu de triangles à dessiner. */
+static GLfloat vertexScore(int cachePos, int valence) {
+  GLfloat s = 0.0f;
+  if(!valence)
+    return -1.0f;
+  if(cachePos >= 0)
+    s = cachePos < 3 ? 0.75f : powf(1.0f - (cachePos - 3) / (GLfloat)(MH_CACHE - 3), 1.5f);
+  return s + 2.0f / sqrtf((GLfloat)valence);
+}
+
+/*!\brief réordonne les triangles de \a index (\a nbIndices indices sur
+ * \a nbVertices sommets) pour que les sommets partagés restent dans le
+ * cache post-transformation : chaque triangle suivant est le mieux noté
+ * parmi ceux des sommets en cache. */
+void mhOptimize(GLuint * index, int nbIndices, int nbVertices) {
+  int nbTris = nbIndices / 3, i, k, n, t, best = 0, next = 0, cacheSize = 0, newSize, nt;
+  int * valence = calloc(nbVertices, sizeof *valence), * offset = malloc((nbVertices + 1) * sizeof *offset);
+  int * tris = malloc(nbIndices * sizeof *tris), * cachePos = malloc(nbVertices * sizeof *cachePos);
+  GLfloat * vScore = malloc(nbVertices * sizeof *vScore), * tScore = malloc(nbTris * sizeof *tScore), bestScore;
+  char * added = calloc(nbTris, 1);
+  GLuint * out = malloc(nbIndices * sizeof *out);
+  int cache[MH_CACHE + 3], newCache[MH_CACHE + 3];
+  assert(valence && offset && tris && cachePos && vScore && tScore && added && out);
+  /* triangles de chaque sommet : tris[offset[v]..offset[v] + valence[v]] */
+  for(i = 0; i < nbIndices; i++)
+    valence[index[i]]++;
+  for(i = 0, offset[0] = 0; i < nbVertices; i++) {
+    offset[i + 1] = offset[i] + valence[i];
+    cachePos[i] = 0;
+  }
+  for(i = 0; i < nbIndices; i++)
+    tris[offset[index[i]] + cachePos[index[i]]++] = i / 3;
+  for(i = 0; i < nbVertices; i++) {
+    cachePos[i] = -1;
+    vScore[i] = vertexScore(-1, valence[i]);
+  }
+  for(t = 0, bestScore = -1.0f; t < nbTris; t++) {
+    tScore[t] = vScore[index[3 * t]] + vScore[index[3 * t + 1]] + vScore[index[3 * t + 2]];
+    if(tScore[t] > bestScore) {
+      bestScore = tScore[t];
+      best = t;
+    }
+  }
+  for(n = 0; n < nbTris; n++) {
+    /* plus aucun triangle en cache : le premier qui reste */
+    if(best < 0) {
+      while(added[next]) next++;
+      best = next;
+    }
+    t = best;
+    added[t] = 1;
+    memcpy(&out[3 * n], &index[3 * t], 3 * sizeof *out);
+    /* retire t des triangles restants de ses sommets, qui passent en
+     * tête du cache */
+    newSize = 0;
+    for(k = 0; k < 3; k++) {
+      int v = index[3 * t + k], * l = &tris[offset[v]];
+      for(i = 0; i < valence[v]; i++)
+        if(l[i] == t) {
+          l[i] = l[--valence[v]];
+          break;
+        }
+      for(i = 0; i < newSize && newCache[i] != v; i++);
+      if(i == newSize)
+        newCache[newSize++] = v;
+    }
+    for(i = 0, nt = newSize; i < cacheSize; i++) {
+      for(k = 0; k < nt && newCache[k] != cache[i]; k++);
+      if(k == nt)
+        newCache[newSize++] = cache[i];
+    }
+    /* nouveaux scores des sommets du cache (et de ceux qui en sortent)
+     * et de leurs triangles ; le suivant est le mieux noté */
+    best = -1;
+    bestScore = -1.0f;
+    for(i = 0; i < newSize; i++) {
+      int v = newCache[i];
+      GLfloat s, d;
+      cachePos[v] = i < MH_CACHE ? i : -1;
+      s = vertexScore(cachePos[v], valence[v]);
+      d = s - vScore[v];
+      vScore[v] = s;
+      for(k = 0; k < valence[v]; k++) {
+        int u = tris[offset[v] + k];
+        tScore[u] += d;
+        if(i < MH_CACHE && tScore[u] > bestScore) {
+          bestScore = tScore[u];
+          best = u;
+        }
+      }
+    }
+    cacheSize = newSize < MH_CACHE ? newSize : MH_CACHE;
+    memcpy(cache, newCache, cacheSize * sizeof *cache);
+  }
+  memcpy(index, out, nbTris * 3 * sizeof *out);
+  free(valence); free(offset); free(tris); free(cachePos);
+  free(vScore); free(tScore); free(added); free(out);
+}
+
+/*!\brief range les \a nbVertices sommets de \a vertices (de \a size
+ * octets chacun) dans l'ordre de leur première utilisation par \a index
+ * et renumérote ce dernier, pour que les lectures de sommets se
+ * suivent en mémoire. Les sommets inutilisés sont placés à la fin. */
+void mhReorderVertices(GLuint * index, int nbIndices, void * vertices, size_t size, int nbVertices) {
+  int i, next = 0;
+  GLuint * remap = malloc(nbVertices * sizeof *remap);
+  char * copy = malloc(nbVertices * size);
+  assert(remap && copy);
+  for(i = 0; i < nbVertices; i++)
+    remap[i] = (GLuint)-1;
+  for(i = 0; i < nbIndices; i++) {
+    if(remap[index[i]] == (GLuint)-1)
+      remap[index[i]] = next++;
+    index[i] = remap[index[i]];
+  }
+  for(i = 0; i < nbVertices; i++)
+    if(remap[i] == (GLuint)-1)
+      remap[i] = next++;
+  memcpy(copy, vertices, nbVertices * size);
+  for(i = 0; i < nbVertices; i++)
+    memcpy((char *)vertices + remap[i] * size, copy + i * size, size);
+  free(remap);
+  free(copy);
+}
+
+/*!\brief renvoie le nombre moyen de sommets transformés par triangle
+ * (ACMR) pour \a index avec un cache FIFO de MH_FIFO sommets : 3 sans
+ * aucun partage, 0.5 au mieux sur une grande grille. */
+GLfloat mhACMR(const GLuint * index, int nbIndices, int nbVertices) {
+  int i, misses = 0;
+  int * stamp = malloc(nbVertices * sizeof *stamp);
+  assert(stamp);
+  for(i = 0; i < nbVertices; i++)
+    stamp[i] = -MH_FIFO;
+  /* un sommet est en cache s'il est entré il y a moins de MH_FIFO défauts */
+  for(i = 0; i < nbIndices; i++)
+    if(misses - stamp[index[i]] >= MH_FIFO)
+      stamp[index[i]] = ++misses;
+  free(stamp);
+  return nbIndices ? misses / (nbIndices / 3.0f) : 0.0f;
+}
+
+/*!\brief composante signée normalisée sur 10 bits */
+static GLuint snorm10(GLfloat f) {
+  f = f < -1.0f ? -1.0f : (f > 1.0f ? 1.0f : f);
+  return (GLuint)(GLint)floorf(f * 511.0f + 0.5f) & 0x3FF;
+}
+
+/*!\brief renvoie la normale (\a x, \a y, \a z) au format
+ * GL_INT_2_10_10_10_REV normalisé. */
+GLuint mhPackNormal(GLfloat x, GLfloat y, GLfloat z) {
+  return snorm10(x) | snorm10(y) << 10 | snorm10(z) << 20;
+}
+
+/*!\brief renvoie \a f en demi-flottant (GL_HALF_FLOAT), arrondi au
+ * plus proche ; les valeurs trop petites deviennent 0 et les trop
+ * grandes l'infini. */
+GLushort mhHalf(GLfloat f) {
+  GLuint u, sign, m;
+  int e;
+  memcpy(&u, &f, sizeof u);
+  sign = (u >> 16) & 0x8000;
+  e = (int)((u >> 23) & 0xFF) - 127 + 15;
+  m = u & 0x7FFFFF;
+  if(e <= 0)
+    return sign;
+  if(e >= 31)
+    return sign | 0x7C00;
+  m += 0x1000;
+  if(m & 0x800000) {
+    m = 0;
+    if(++e >= 31)
+      return sign | 0x7C00;
+  }
+  return sign | e << 10 | m >> 13;
+}
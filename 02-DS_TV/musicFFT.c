@@ -9,13 +9,14 @@
 #include <fftw3.h>
 #include <GL4D/gl4dh.h>
 #include "audioHelper.h"
+#include "drawHelper.h"
+#include "stateHelper.h"
 
 #define ECHANTILLONS 1024
 
 static void init(int w, int h);
 static void audio(void);
 static void draw(void);
-static void drawPixelWithThickness(int x, int y, int t);
 static void quit(void);
 
 /* !\brief structure représentant un cercle */
@@ -65,16 +66,6 @@ static void init(int w, int h) {
   _mobile.c = RGB(255, 255, 255);
 }
 
-/* !\brief dessine un point selon l'épaisseur donnée */
-static void drawPixelWithThickness(int x, int y, int t) {
-  int i;
-  for(i = 0; i < t; i++) {
-    gl4dpPutPixel(x+i, y+i);
-    gl4dpPutPixel(x, y);
-    gl4dpPutPixel(x-i, y-i);
-  }
-}
-
 /* !\brief transforme le cercle en une ligne (en aplatissant le cercle) */
 static void circleToLine(void) {
   static int _gap = 0; 
@@ -138,11 +129,12 @@ static void draw(void) {
         int x0, y0;
         x0 = (i * (_w - 1)) / (ECHANTILLONS - 1);
         y0 = _hauteurs[i];
-        drawPixelWithThickness(x0 + _w/2, y0 + _h/2, 3);
+        dhPoint(x0 + _w/2, y0 + _h/2, 3);
       }
     }
   }
   gl4dpUpdateScreen(NULL);
+  shInvalidate(SH_PROGRAM_BIT | SH_TEXTURE_BIT | SH_ENABLE_BIT);
 }
 
 /* !\brief initialise les paramètres de la lib FFTW */
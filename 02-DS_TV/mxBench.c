@@ -0,0 +1,86 @@
+/*!\file mxBench.c
+ *
+ * \brief compare le calcul de matrices modèle par la pile gl4du
+ * (gl4duPushMatrix, gl4duTranslatef, gl4duRotatef, gl4duScalef) et par
+ * mxCompose. Usage : ./mxBench [nombre de matrices] ; "make bench".
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <GL4D/gl4du.h>
+#include "mxHelper.h"
+
+/*!\brief nombre de répétitions de chaque mesure */
+#define REPEAT 20
+
+/*!\brief renvoie le temps processeur écoulé depuis \a t0, en
+ * secondes. */
+static double since(clock_t t0) {
+  return (clock() - t0) / (double)CLOCKS_PER_SEC;
+}
+
+int main(int argc, char ** argv) {
+  int i, r, n = argc > 1 ? atoi(argv[1]) : 10000, parent;
+  mxTRS_t * trs;
+  GLfloat * a, * b, err = 0.0f;
+  clock_t t0;
+  double tu, tm;
+  if(n <= 0)
+    return 1;
+  gl4duInit(argc, argv);
+  trs = malloc(n * sizeof *trs);
+  a = malloc(16 * n * sizeof *a);
+  b = malloc(16 * n * sizeof *b);
+  if(!trs || !a || !b)
+    return 1;
+  /* transformations de l'anneau de cubes de cube.c */
+  for(i = 0; i < n; i++) {
+    GLfloat angle = 360.0f * i / n, s = 0.05f + 0.01f * (i % 7);
+    trs[i].t[0] = 5.0f * cosf(angle * (GLfloat)M_PI / 180.0f);
+    trs[i].t[1] = 0.0f;
+    trs[i].t[2] = -8.0f - 5.0f * sinf(angle * (GLfloat)M_PI / 180.0f);
+    trs[i].angle = angle;
+    trs[i].axis[0] = 0.0f; trs[i].axis[1] = 1.0f; trs[i].axis[2] = 0.0f;
+    trs[i].s[0] = trs[i].s[1] = trs[i].s[2] = s;
+  }
+
+  gl4duGenMatrix(GL_FLOAT, "modelViewMatrix");
+  gl4duBindMatrix("modelViewMatrix");
+  gl4duLoadIdentityf();
+  gl4duTranslatef(0, 0, -3);
+  t0 = clock();
+  for(r = 0; r < REPEAT; r++) {
+    gl4duBindMatrix("modelViewMatrix");
+    for(i = 0; i < n; i++) {
+      gl4duPushMatrix();
+      gl4duTranslatef(trs[i].t[0], trs[i].t[1], trs[i].t[2]);
+      gl4duRotatef(trs[i].angle, trs[i].axis[0], trs[i].axis[1], trs[i].axis[2]);
+      gl4duScalef(trs[i].s[0], trs[i].s[1], trs[i].s[2]);
+      memcpy(&a[16 * i], gl4duGetMatrixData(), 16 * sizeof *a);
+      gl4duPopMatrix();
+    }
+  }
+  tu = since(t0);
+
+  parent = mxGen();
+  memcpy(mxData(parent), gl4duGetMatrixData(), 16 * sizeof *a);
+  t0 = clock();
+  for(r = 0; r < REPEAT; r++)
+    mxCompose(parent, n, trs, b);
+  tm = since(t0);
+
+  for(i = 0; i < 16 * n; i++)
+    err = fmaxf(err, fabsf(a[i] - b[i]));
+  printf("%d matrices x %d\n", n, REPEAT);
+  printf("gl4du     : %8.1f ns par matrice\n", 1e9 * tu / ((double)n * REPEAT));
+  printf("mxCompose : %8.1f ns par matrice (x%.1f)\n", 1e9 * tm / ((double)n * REPEAT), tm > 0 ? tu / tm : 0.0);
+  printf("écart maximal : %g\n", err);
+  free(trs);
+  free(a);
+  free(b);
+  mxClean();
+  gl4duClean(GL4DU_ALL);
+  return 0;
+}
@@ -0,0 +1,176 @@
+#include "mxHelper.h"
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+/*!\brief nombre maximal de matrices désignées par mxGen */
+#define MX_MAX 64
+
+/* Une ligne de matrice (quatre flottants) et ses opérations : SSE sur
+ * x86, NEON sur ARM, et à défaut une version scalaire. */
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#  include <xmmintrin.h>
+typedef __m128 mxRow_t;
+static inline mxRow_t load(const GLfloat * p)          { return _mm_load_ps(p); }
+static inline void    storeu(GLfloat * p, mxRow_t r)   { _mm_storeu_ps(p, r); }
+static inline mxRow_t set(GLfloat x, GLfloat y, GLfloat z, GLfloat w) { return _mm_setr_ps(x, y, z, w); }
+static inline mxRow_t splat(GLfloat f)                 { return _mm_set1_ps(f); }
+static inline mxRow_t add(mxRow_t a, mxRow_t b)        { return _mm_add_ps(a, b); }
+static inline mxRow_t sub(mxRow_t a, mxRow_t b)        { return _mm_sub_ps(a, b); }
+static inline mxRow_t mul(mxRow_t a, mxRow_t b)        { return _mm_mul_ps(a, b); }
+static inline mxRow_t yzx(mxRow_t a)                   { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)); }
+static inline mxRow_t zxy(mxRow_t a)                   { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2)); }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+typedef float32x4_t mxRow_t;
+static inline mxRow_t load(const GLfloat * p)          { return vld1q_f32(p); }
+static inline void    storeu(GLfloat * p, mxRow_t r)   { vst1q_f32(p, r); }
+static inline mxRow_t set(GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
+  GLfloat v[4] = { x, y, z, w };
+  return vld1q_f32(v);
+}
+static inline mxRow_t splat(GLfloat f)                 { return vdupq_n_f32(f); }
+static inline mxRow_t add(mxRow_t a, mxRow_t b)        { return vaddq_f32(a, b); }
+static inline mxRow_t sub(mxRow_t a, mxRow_t b)        { return vsubq_f32(a, b); }
+static inline mxRow_t mul(mxRow_t a, mxRow_t b)        { return vmulq_f32(a, b); }
+static inline mxRow_t yzx(mxRow_t a) {
+  mxRow_t t = vextq_f32(a, a, 1); /* y z w x */
+  return vsetq_lane_f32(vgetq_lane_f32(a, 3), vsetq_lane_f32(vgetq_lane_f32(a, 0), t, 2), 3);
+}
+static inline mxRow_t zxy(mxRow_t a) {
+  mxRow_t t = vextq_f32(a, a, 3); /* w x y z */
+  return vsetq_lane_f32(vgetq_lane_f32(a, 3), vsetq_lane_f32(vgetq_lane_f32(a, 2), t, 0), 3);
+}
+#else
+typedef struct { GLfloat v[4]; } mxRow_t;
+static inline mxRow_t load(const GLfloat * p)          { mxRow_t r; memcpy(r.v, p, sizeof r.v); return r; }
+static inline void    storeu(GLfloat * p, mxRow_t r)   { memcpy(p, r.v, sizeof r.v); }
+static inline mxRow_t set(GLfloat x, GLfloat y, GLfloat z, GLfloat w) { mxRow_t r = { { x, y, z, w } }; return r; }
+static inline mxRow_t splat(GLfloat f)                 { return set(f, f, f, f); }
+static inline mxRow_t add(mxRow_t a, mxRow_t b) {
+  return set(a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]);
+}
+static inline mxRow_t sub(mxRow_t a, mxRow_t b) {
+  return set(a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]);
+}
+static inline mxRow_t mul(mxRow_t a, mxRow_t b) {
+  return set(a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]);
+}
+static inline mxRow_t yzx(mxRow_t a)                   { return set(a.v[1], a.v[2], a.v[0], a.v[3]); }
+static inline mxRow_t zxy(mxRow_t a)                   { return set(a.v[2], a.v[0], a.v[1], a.v[3]); }
+#endif
+
+/*!\brief une matrice, lisible par flottants ou par lignes (ce qui
+ * l'aligne sur 16 octets) */
+typedef union mxMat_t mxMat_t;
+union mxMat_t {
+  GLfloat m[16];
+  mxRow_t r[4];
+};
+
+/*!\brief matrices désignées par mxGen et leur nombre */
+static mxMat_t _mats[MX_MAX];
+static int _nbMats = 0;
+
+/*!\brief écrit dans \a out le produit \a a * (b0, b1, b2, b3) : la
+ * ligne i du produit combine les lignes de b par les coefficients de la
+ * ligne i de \a a. \a out peut être \a a. */
+static inline void product(const GLfloat * a, mxRow_t b0, mxRow_t b1, mxRow_t b2, mxRow_t b3, GLfloat * out) {
+  int i;
+  for(i = 0; i < 4; i++, a += 4, out += 4) {
+    mxRow_t r = add(add(mul(splat(a[0]), b0), mul(splat(a[1]), b1)),
+                    add(mul(splat(a[2]), b2), mul(splat(a[3]), b3)));
+    storeu(out, r);
+  }
+}
+
+/*!\brief range dans \a r les lignes de la transformation \a trs. */
+static inline void trsRows(const mxTRS_t * trs, mxRow_t * r) {
+  GLfloat x = trs->axis[0], y = trs->axis[1], z = trs->axis[2];
+  GLfloat n = sqrtf(x * x + y * y + z * z), a = trs->angle * (GLfloat)M_PI / 180.0f;
+  GLfloat c = cosf(a), s = sinf(a), ic;
+  if(n > 0.0f) {
+    x /= n; y /= n; z /= n;
+  } else
+    c = 1.0f, s = 0.0f;
+  ic = 1.0f - c;
+  r[0] = mul(set(x * x * ic + c,     x * y * ic - z * s, x * z * ic + y * s, trs->t[0]),
+             set(trs->s[0], trs->s[1], trs->s[2], 1.0f));
+  r[1] = mul(set(y * x * ic + z * s, y * y * ic + c,     y * z * ic - x * s, trs->t[1]),
+             set(trs->s[0], trs->s[1], trs->s[2], 1.0f));
+  r[2] = mul(set(z * x * ic - y * s, z * y * ic + x * s, z * z * ic + c,     trs->t[2]),
+             set(trs->s[0], trs->s[1], trs->s[2], 1.0f));
+  r[3] = set(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+/*!\brief renvoie l'indice d'une nouvelle matrice, l'identité. */
+int mxGen(void) {
+  assert(_nbMats < MX_MAX);
+  mxIdentity(_nbMats);
+  return _nbMats++;
+}
+
+/*!\brief renvoie les 16 flottants de la matrice \a m. */
+GLfloat * mxData(int m) {
+  return _mats[m].m;
+}
+
+void mxIdentity(int m) {
+  _mats[m].r[0] = set(1.0f, 0.0f, 0.0f, 0.0f);
+  _mats[m].r[1] = set(0.0f, 1.0f, 0.0f, 0.0f);
+  _mats[m].r[2] = set(0.0f, 0.0f, 1.0f, 0.0f);
+  _mats[m].r[3] = set(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+/*!\brief \a dst = \a a * \a b ; \a dst peut être \a a ou \a b. */
+void mxMul(int dst, int a, int b) {
+  const mxRow_t * rb = _mats[b].r;
+  product(_mats[a].m, rb[0], rb[1], rb[2], rb[3], _mats[dst].m);
+}
+
+/*!\brief \a m = translation * rotation * échelle de \a trs. */
+void mxTRS(int m, const mxTRS_t * trs) {
+  trsRows(trs, _mats[m].r);
+}
+
+/*!\brief \a dst = inverse transposée de la partie 3x3 de \a src (pour
+ * les normales) : ses lignes sont les cofacteurs, produits vectoriels
+ * des lignes de \a src, divisés par le déterminant. */
+void mxNormal(int dst, int src) {
+  mxRow_t r0 = _mats[src].r[0], r1 = _mats[src].r[1], r2 = _mats[src].r[2], c0, c1, c2;
+  GLfloat d[4], det;
+  /* la quatrième composante (translation) s'annule dans les produits */
+  c0 = sub(mul(yzx(r1), zxy(r2)), mul(zxy(r1), yzx(r2)));
+  c1 = sub(mul(yzx(r2), zxy(r0)), mul(zxy(r2), yzx(r0)));
+  c2 = sub(mul(yzx(r0), zxy(r1)), mul(zxy(r0), yzx(r1)));
+  storeu(d, mul(r0, c0));
+  det = d[0] + d[1] + d[2];
+  det = det != 0.0f ? 1.0f / det : 0.0f;
+  _mats[dst].r[0] = mul(c0, splat(det));
+  _mats[dst].r[1] = mul(c1, splat(det));
+  _mats[dst].r[2] = mul(c2, splat(det));
+  _mats[dst].r[3] = set(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+/*!\brief écrit dans \a out (16 * \a n flottants, sans contrainte
+ * d'alignement) les matrices \a parent * \a trs[i]. */
+void mxCompose(int parent, int n, const mxTRS_t * trs, GLfloat * out) {
+  int i;
+  mxRow_t r[4];
+  for(i = 0; i < n; i++, out += 16) {
+    trsRows(&trs[i], r);
+    product(_mats[parent].m, r[0], r[1], r[2], r[3], out);
+  }
+}
+
+/*!\brief copie la matrice \a m dans la matrice gl4du \a name (et lie
+ * cette dernière). */
+void mxLoad(int m, const char * name) {
+  gl4duBindMatrix(name);
+  gl4duLoadMatrixf(_mats[m].m);
+}
+
+/*!\brief oublie toutes les matrices. */
+void mxClean(void) {
+  _nbMats = 0;
+}
@@ -0,0 +1,38 @@
+#ifndef _MX_HELPER_H
+
+#define _MX_HELPER_H
+
+#include <GL4D/gl4du.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  /*!\brief une transformation translation * rotation * échelle, dans
+   * l'ordre de gl4duTranslatef, gl4duRotatef puis gl4duScalef */
+  typedef struct mxTRS_t mxTRS_t;
+  struct mxTRS_t {
+    GLfloat t[3];    /* translation */
+    GLfloat angle;   /* rotation en degrés */
+    GLfloat axis[3]; /* axe de la rotation, normalisé par mxTRS */
+    GLfloat s[3];    /* échelle */
+  };
+
+  /* Les matrices sont désignées par des indices obtenus à
+   * l'initialisation (mxGen) et rangées par lignes comme celles de
+   * gl4du, alignées sur 16 octets. */
+  extern int       mxGen(void);
+  extern GLfloat * mxData(int m);
+  extern void      mxIdentity(int m);
+  extern void      mxMul(int dst, int a, int b);
+  extern void      mxTRS(int m, const mxTRS_t * trs);
+  extern void      mxNormal(int dst, int src);
+  extern void      mxCompose(int parent, int n, const mxTRS_t * trs, GLfloat * out);
+  extern void      mxLoad(int m, const char * name);
+  extern void      mxClean(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,125 @@
+#include "normalMapHelper.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+/*!\brief hauteur (canal rouge, dans [0, 1]) du texel (\a x, \a y) de
+ * \a s, les coordonnées bouclant comme en GL_REPEAT. */
+static float height(SDL_Surface * s, int x, int y) {
+  const Uint8 * p = s->pixels;
+  x = (x + s->w) % s->w;
+  y = (y + s->h) % s->h;
+  return p[y * s->pitch + x * s->format->BytesPerPixel] / 255.0f;
+}
+
+/*!\brief niveau 0 : normale (x, y, z) de chaque texel, obtenue par
+ * le filtre de Sobel que les shaders appliquaient à chaque fragment
+ * (gradients multipliés par \a sx et \a sy), suivie de la hauteur,
+ * toujours utilisée par les vertex shaders. */
+static void sobel(SDL_Surface * s, float * n, GLfloat sx, GLfloat sy) {
+  int x, y;
+  for(y = 0; y < s->h; y++)
+    for(x = 0; x < s->w; x++, n += 4) {
+      float gx = height(s, x + 1, y - 1) + 2.0f * height(s, x + 1, y) + height(s, x + 1, y + 1)
+	- height(s, x - 1, y - 1) - 2.0f * height(s, x - 1, y) - height(s, x - 1, y + 1);
+      float gy = height(s, x - 1, y - 1) + 2.0f * height(s, x, y - 1) + height(s, x + 1, y - 1)
+	- height(s, x - 1, y + 1) - 2.0f * height(s, x, y + 1) - height(s, x + 1, y + 1);
+      float l;
+      n[0] = sx * gx; n[1] = sy * gy; n[2] = 1.0f; n[3] = height(s, x, y);
+      l = 1.0f / sqrtf(n[0] * n[0] + n[1] * n[1] + 1.0f);
+      n[0] *= l; n[1] *= l; n[2] *= l;
+    }
+}
+
+#ifdef __SSE2__
+/*!\brief normalise les trois premières composantes de \a v et garde
+ * la quatrième : rsqrt affiné d'une itération de Newton. */
+static inline __m128 normalize3(__m128 v) {
+  const __m128 xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+  __m128 n = _mm_and_ps(v, xyz), d = _mm_mul_ps(n, n), r;
+  d = _mm_add_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 3, 0, 1)));
+  d = _mm_max_ps(_mm_add_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 0, 3, 2))), _mm_set1_ps(1e-12f));
+  r = _mm_rsqrt_ps(d);
+  r = _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_set1_ps(0.5f), _mm_mul_ps(d, _mm_mul_ps(r, r)))));
+  return _mm_or_ps(_mm_mul_ps(n, r), _mm_andnot_ps(xyz, v));
+}
+#endif
+
+/*!\brief réduit le niveau \a src (\a w x \a h) dans \a dst en
+ * sommant chaque bloc 2x2 de normales puis en renormalisant (la
+ * hauteur est moyennée) ; un texel par registre SSE2. */
+static void downsample(const float * src, int w, int h, float * dst) {
+  int x, y, w2 = MAX(w / 2, 1), h2 = MAX(h / 2, 1);
+  for(y = 0; y < h2; y++) {
+    const float * r0 = &src[4 * (2 * y) * w], * r1 = &src[4 * MIN(2 * y + 1, h - 1) * w];
+    for(x = 0; x < w2; x++, dst += 4) {
+      int x0 = 4 * 2 * x, x1 = 4 * MIN(2 * x + 1, w - 1);
+#ifdef __SSE2__
+      __m128 s = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(&r0[x0]), _mm_loadu_ps(&r0[x1])),
+			    _mm_add_ps(_mm_loadu_ps(&r1[x0]), _mm_loadu_ps(&r1[x1])));
+      _mm_storeu_ps(dst, normalize3(_mm_mul_ps(s, _mm_set_ps(0.25f, 1.0f, 1.0f, 1.0f))));
+#else
+      int k;
+      float l;
+      for(k = 0; k < 4; k++)
+	dst[k] = r0[x0 + k] + r0[x1 + k] + r1[x0 + k] + r1[x1 + k];
+      l = sqrtf(dst[0] * dst[0] + dst[1] * dst[1] + dst[2] * dst[2]);
+      l = l > 0.0f ? 1.0f / l : 0.0f;
+      dst[0] *= l; dst[1] *= l; dst[2] *= l; dst[3] *= 0.25f;
+#endif
+    }
+  }
+}
+
+/*!\brief convertit les \a n texels de \a src en RGBA8 : la normale
+ * en n * 0.5 + 0.5, la hauteur telle quelle. */
+static void pack(const float * src, int n, Uint8 * dst) {
+  int i;
+#ifdef __SSE2__
+  const __m128 a = _mm_set_ps(255.0f, 127.5f, 127.5f, 127.5f), b = _mm_set_ps(0.0f, 127.5f, 127.5f, 127.5f);
+#else
+  const float a[4] = { 127.5f, 127.5f, 127.5f, 255.0f }, b[4] = { 127.5f, 127.5f, 127.5f, 0.0f };
+#endif
+  for(i = 0; i < n; i++, src += 4, dst += 4) {
+#ifdef __SSE2__
+    __m128i v = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src), a), b));
+    v = _mm_packus_epi16(_mm_packs_epi32(v, v), v);
+    *(Uint32 *)dst = (Uint32)_mm_cvtsi128_si32(v);
+#else
+    int k;
+    for(k = 0; k < 4; k++)
+      dst[k] = (Uint8)(src[k] * a[k] + b[k] + 0.5f);
+#endif
+  }
+}
+
+/*!\brief remplit la texture GL_TEXTURE_2D liée avec la carte de
+ * normales (espace tangent, RGB = n * 0.5 + 0.5, A = hauteur) tirée de
+ * la carte de hauteur \a bump (canal rouge) et toute sa chaîne de
+ * mipmaps, calculées une fois pour toutes au chargement. Les gradients
+ * de Sobel (pas d'un texel) sont multipliés par \a sx et \a sy. */
+void nmTexImage(SDL_Surface * bump, GLfloat sx, GLfloat sy) {
+  int w = bump->w, h = bump->h, level = 0;
+  float * cur = malloc(w * h * 4 * sizeof *cur), * next = malloc(MAX(w / 2, 1) * MAX(h / 2, 1) * 4 * sizeof *next), * t;
+  Uint8 * bytes = malloc(w * h * 4);
+  assert(cur && next && bytes);
+  sobel(bump, cur, sx, sy);
+  for(;;) {
+    pack(cur, w * h, bytes);
+    glTexImage2D(GL_TEXTURE_2D, level++, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, bytes);
+    if(w == 1 && h == 1)
+      break;
+    downsample(cur, w, h, next);
+    w = MAX(w / 2, 1);
+    h = MAX(h / 2, 1);
+    t = cur; cur = next; next = t;
+  }
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  free(cur);
+  free(next);
+  free(bytes);
+}
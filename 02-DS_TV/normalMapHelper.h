@@ -0,0 +1,18 @@
+#ifndef _NORMAL_MAP_HELPER_H
+
+#define _NORMAL_MAP_HELPER_H
+
+#include <GL4D/gl4du.h>
+#include <SDL.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  extern void nmTexImage(SDL_Surface * bump, GLfloat sx, GLfloat sy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -5,6 +5,11 @@
 #include <SDL_mixer.h>
 #include <GL4D/gl4dh.h>
 #include "audioHelper.h"
+#include "normalMapHelper.h"
+#include "lodHelper.h"
+#include "postHelper.h"
+#include "variantHelper.h"
+#include "stateHelper.h"
 
 static void  init(int w, int h);
 static void  draw(void);
@@ -16,8 +21,18 @@ static GLuint _screen = 0;
 static int _w, _h;
 /*!\brief identifiant de la texture */
 static GLuint _tId = 0;
-/*!\brief identifiant du programme GLSL */
-static GLuint _pId = 0;
+/*!\brief identifiant de la carte de normales tirée de la texture */
+static GLuint _nmId = 0;
+/*!\brief variantes du programme GLSL : étoiles (instanciées), "pacman"
+ * et "pacman" pixellisé */
+enum { PM_STARS = 0, PM_PACMAN, PM_PACMAN_PIXEL, PM_NB };
+static GLuint _pId[PM_NB] = {0};
+/*!\brief uniforms de chaque variante, relevés à l'initialisation
+ * (basses et temps viennent du bloc "frame") ; "pacman" est le nom de
+ * la texture */
+enum { U_PACMAN = 0, U_EBUMP, U_STATE, U_LUMPOS, U_IMPOSTOR, U_NB };
+static const char * const _uNames[U_NB] = { "pacman", "ebump", "state", "lumPos", "impostor" };
+static GLint _u[PM_NB][U_NB];
 /*!\brief identifiant de la sphère de GL4Dummies */
 static GLuint _sphere = 0;
 /*!\brief dimension de la sphère "pacman" */
@@ -34,8 +49,6 @@ static GLuint _longitudes = 200, _latitudes = 200;
 static GLfloat _lumPos0[4] = {-15.1, 20.0, 20.7, 1.0};
 /*!\brief fichier contenant la texture */
 static const char * _texture_filename = "images/pacman.png";
-/*!\brief nom de la texture */
-static const char * _sampler_name = "pacman";
 /*!\brief précision concernant la représentation de la texture */
 static GLfloat _pixelPrec = 1.0;
 /* !\brief basses de la démo */
@@ -46,6 +59,10 @@ static int _pixel = 0;
 static int _swirl = 0;
 /*!\brief état de la démo */
 static int _state = 0;
+/*!\brief post-traitement : tourbillon en demi-résolution puis
+ * pixellisation */
+static phChain_t * _post = NULL;
+static int _postSwirl = 0, _postPixel = 0;
 
 /*!\brief initialise les paramètres OpenGL et les données */
 static void init(int w, int h) {
@@ -56,24 +73,42 @@ static void init(int w, int h) {
   if(!_tId) {
     glGenTextures(1, &_tId);
     SDL_Surface * t;
-    glBindTexture(GL_TEXTURE_2D, _tId);
+    shBindTexture(GL_TEXTURE_2D, _tId);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glGenTextures(1, &_nmId);
     if( (t = IMG_Load(_texture_filename)) != NULL ) {
       int mode = t->format->BytesPerPixel == 4 ? GL_RGBA : GL_RGB;    
       glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, t->w, t->h, 0, mode, GL_UNSIGNED_BYTE, t->pixels);
+      /* le canal rouge sert de relief : carte de normales calculée une
+       * fois, à l'échelle du Sobel que faisait pmsphere.fs avec un pas
+       * d'un pixel écran */
+      shBindTexture(GL_TEXTURE_2D, _nmId);
+      nmTexImage(t, 0.75f * t->w / _w, 0.75f * t->h / _h);
       SDL_FreeSurface(t);
     } else {
       fprintf(stderr, "can't open file %s : %s\n", _texture_filename, SDL_GetError());
       glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+      shBindTexture(GL_TEXTURE_2D, _nmId);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, (const GLubyte[]){ 128, 128, 255, 128 });
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     }
+    shBindTexture(GL_TEXTURE_2D, 0);
   }
 
   glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-  _pId  = gl4duCreateProgram("<vs>shaders/pmsphere.vs", "<fs>shaders/pmsphere.fs", NULL);
+  _pId[PM_STARS]        = vhProgram("shaders/pmsphere.vs", "shaders/pmsphere.fs", "#define INSTANCED\n");
+  _pId[PM_PACMAN]       = vhProgram("shaders/pmsphere.vs", "shaders/pmsphere.fs", "#define PACMAN\n");
+  _pId[PM_PACMAN_PIXEL] = vhProgram("shaders/pmsphere.vs", "shaders/pmsphere.fs", "#define PACMAN\n#define PIXEL\n");
+  for(i = 0; i < PM_NB; i++)
+    vhUniforms(_pId[i], _uNames, U_NB, _u[i]);
   gl4duGenMatrix(GL_FLOAT, "modelViewMatrix");
   gl4duGenMatrix(GL_FLOAT, "projectionMatrix");
   _sphere = gl4dgGenSpheref(_longitudes, _latitudes);
+  lhInit();
+  _post = phNew();
+  _postSwirl = phAdd(_post, PH_SWIRL, 0.5f);
+  _postPixel = phAdd(_post, PH_PIXELATE, 1.0f);
 
   /* initialise les coordonnées des sphères "étoiles" */
   for(i = 0; i < _nbStars; i++)
@@ -86,64 +121,70 @@ static void draw(void) {
   static GLfloat a0 = 0.0;
   static Uint32 t0 = 0;
   int i;
+  int v = _pixel ? PM_PACMAN_PIXEL : PM_PACMAN;
   GLint vp[4];
-  GLfloat dt = 0.0, steps[2] = {1.0f / _w, 1.0f / _h};
+  GLfloat dt = 0.0;
   GLfloat lumPos[4], *mat;
   Uint32 t = SDL_GetTicks();
   dt = (t - t0) / 1000.0;
   t0 = t;
 
-  GLboolean gdt = glIsEnabled(GL_DEPTH_TEST);
-  glGetIntegerv(GL_VIEWPORT, vp);
+  GLboolean gdt = shIsEnabled(GL_DEPTH_TEST);
+  shGetViewport(vp);
   gl4duBindMatrix("projectionMatrix");
   gl4duLoadIdentityf();
   gl4duFrustumf(-0.5, 0.5, -0.5 * vp[3] / vp[2], 0.5 * vp[3] / vp[2], 1.0, 1000.0);
+  lhBegin();
   gl4duBindMatrix("modelViewMatrix");
   
+  /* tourbillon et pixellisation s'appliquent à l'image entière, à
+   * moindre résolution */
+  phSet(_post, _postSwirl, _swirl, phSwirlAngle(5.0f, 50.0f, t));
+  phSet(_post, _postPixel, _pixel, 0.5f * vp[3] / _pixelPrec);
+  phBegin(_post);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  glDisable(GL_CULL_FACE);
-  glEnable(GL_DEPTH_TEST);
-  glDisable(GL_BLEND);
+  shDisable(GL_CULL_FACE);
+  shEnable(GL_DEPTH_TEST);
+  shDisable(GL_BLEND);
   gl4duBindMatrix("modelViewMatrix");
   gl4duLoadIdentityf();
   mat = gl4duGetMatrixData();
   MMAT4XVEC4(lumPos, mat, _lumPos0);
 
   /* dessine la sphère "pacman" */
-  glUseProgram(_pId);
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, _tId);
+  shUseProgram(_pId[v]);
+  shActiveTexture(GL_TEXTURE1);
+  shBindTexture(GL_TEXTURE_2D, _nmId);
+  shActiveTexture(GL_TEXTURE0);
+  shBindTexture(GL_TEXTURE_2D, _tId);
   gl4duPushMatrix(); {
     gl4duTranslatef(_spherePos[0], _spherePos[1], _spherePos[2]);
     gl4duRotatef(a0, 0, 1, 0);
     gl4duScalef(_sphereSize, _sphereSize, _sphereSize);
-    glUniform1i(glGetUniformLocation(_pId, _sampler_name), 0);
-    glUniform1i(glGetUniformLocation(_pId, "id"), 1);
-    glUniform1i(glGetUniformLocation(_pId, "basses"), _basses);
-    glUniform1i(glGetUniformLocation(_pId, "swirl"), _swirl);
-    glUniform1i(glGetUniformLocation(_pId, "pixel"), _pixel);
-    glUniform1i(glGetUniformLocation(_pId, "state"), _state);
-    glUniform1f(glGetUniformLocation(_pId, "pixelPrec"), _pixelPrec);
-    glUniform1i(glGetUniformLocation(_pId, "time"), t);
-    glUniform2fv(glGetUniformLocation(_pId, "steps"), 1, steps);
-    glUniform4fv(glGetUniformLocation(_pId, "lumPos"), 1, lumPos);
+    glUniform1i(_u[v][U_PACMAN], 0);
+    glUniform1i(_u[v][U_EBUMP], 1);
+    glUniform1i(_u[v][U_STATE], _state);
+    glUniform4fv(_u[v][U_LUMPOS], 1, lumPos);
     gl4duSendMatrices();
   } gl4duPopMatrix();
   gl4dgDraw(_sphere);
   
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, 0);
+  shActiveTexture(GL_TEXTURE1);
+  shBindTexture(GL_TEXTURE_2D, 0);
+  shActiveTexture(GL_TEXTURE0);
+  shBindTexture(GL_TEXTURE_2D, 0);
 
   /* dessine les sphères "étoiles" */
-  for(i = 0; i < _nbStars/2; i++) {
-    gl4duPushMatrix(); {
-      gl4duTranslatef(_starsPos[i], _starsPos[i + 1], -3.0);
-      gl4duScalef(_basses * 0.001, _basses * 0.001, _basses * 0.001);
-      glUniform1i(glGetUniformLocation(_pId, "id"), 2);
-      gl4duSendMatrices();
-    } gl4duPopMatrix();
-    if(_state >= 4 || _state < 0) gl4dgDraw(_sphere);
-  } 
+  shUseProgram(_pId[PM_STARS]);
+  glUniform1i(_u[PM_STARS][U_STATE], _state);
+  if(_state >= 4 || _state < 0) {
+    /* une instance par étoile, dessinées en un appel par niveau de
+     * détail plutôt qu'une sphère de 200 x 200 chacune */
+    for(i = 0; i < _nbStars/2; i++)
+      lhAdd(_starsPos[i], _starsPos[i + 1], -3.0, _basses * 0.001, NULL, 0);
+    gl4duSendMatrices();
+    lhDraw(_u[PM_STARS][U_IMPOSTOR]);
+  }
 
   a0 += 1000.0 * dt / 24.0;
   if(prev_basses == 5 && _basses == 6 && _state < 3) _state++;
@@ -155,15 +196,20 @@ static void draw(void) {
   if(_state >= 14 && _basses >= prev_basses) { _state = -99; }
   prev_basses = _basses;
 
+  phEnd(_post);
   if(!gdt)
-    glDisable(GL_DEPTH_TEST);
+    shDisable(GL_DEPTH_TEST);
 }
 
 /* !\brief libère les éléments OpenGL utilisés */
 static void quit(void) {
+  lhClean();
+  phDelete(_post);
+  _post = NULL;
   if(_tId) {
     glDeleteTextures(1, &_tId);
-    _tId = 0;
+    glDeleteTextures(1, &_nmId);
+    _tId = _nmId = 0;
   }
 
   if(_screen) {
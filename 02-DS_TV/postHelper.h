@@ -0,0 +1,34 @@
+#ifndef _POST_HELPER_H
+
+#define _POST_HELPER_H
+
+#include <GL4D/gl4du.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  /*!\brief types de passes de post-traitement */
+  enum phType_t {
+    PH_SWIRL = 0, /* tourbillon, paramètre : angle (radians) au centre */
+    PH_PIXELATE,  /* pixellisation, paramètre : taille des pixels */
+    PH_FADE,      /* fondu au noir, paramètre : dans [0, 1] */
+    PH_BLUR,      /* flou gaussien, paramètre : pas en texels */
+    PH_NB_TYPES
+  };
+
+  typedef struct phChain_t phChain_t;
+
+  extern phChain_t * phNew(void);
+  extern int         phAdd(phChain_t * c, int type, GLfloat scale);
+  extern void        phSet(phChain_t * c, int pass, int enabled, GLfloat param);
+  extern GLfloat     phSwirlAngle(GLfloat rate, GLfloat center, GLfloat ms);
+  extern void        phBegin(phChain_t * c);
+  extern void        phEnd(phChain_t * c);
+  extern void        phDelete(phChain_t * c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,202 @@
+#include "rqHelper.h"
+#include "stateHelper.h"
+#include <GL4D/gl4dg.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*!\brief nombre maximal de constantes propres à un dessin */
+#define RQ_UNIFORMS 4
+/*!\brief nombre de cibles pouvant recevoir une vue (voir rqView) */
+#define RQ_TARGETS 8
+
+/*!\brief une constante propre à un dessin : sa position dans le
+ * programme et sa valeur (un vec4 ou un entier) */
+typedef struct rqUniform_t rqUniform_t;
+struct rqUniform_t {
+  GLint loc;
+  int isInt;
+  GLfloat v[4];
+  GLint i;
+};
+
+/*!\brief un dessin : la géométrie GL4Dummies, le programme, la
+ * texture de l'unité 0, la matrice courante au moment de la soumission
+ * et ses constantes */
+typedef struct rqItem_t rqItem_t;
+struct rqItem_t {
+  int target;
+  GLuint mesh, pId, tId;
+  GLfloat matrix[16];
+  rqUniform_t uniforms[RQ_UNIFORMS];
+  int nbUniforms;
+};
+
+/*!\brief clé de tri d'un dessin et son indice dans la file */
+typedef struct rqKey_t rqKey_t;
+struct rqKey_t {
+  uint64_t key;
+  int item;
+};
+
+/*!\brief file de dessins. \a matrix est la matrice GL4Dummies copiée
+ * à chaque soumission et rechargée à l'exécution ; les autres matrices
+ * et les constantes communes sont fixées avant rqFlush. \a views est
+ * la vue de chaque cible, quand elle est donnée, pour la profondeur. */
+struct rqQueue_t {
+  char * matrix;
+  rqItem_t * items;
+  rqKey_t * keys;
+  int nbItems, size;
+  GLfloat views[RQ_TARGETS][16];
+  int hasView[RQ_TARGETS];
+};
+
+/*!\brief renvoie une clé dont l'ordre suit celui des flottants \a f
+ * (négatifs compris) */
+static uint32_t floatKey(GLfloat f) {
+  uint32_t u;
+  memcpy(&u, &f, sizeof u);
+  return u & 0x80000000u ? ~u : u | 0x80000000u;
+}
+
+/*!\brief clé de tri : cible (8 bits), programme (16 bits), texture (16
+ * bits) puis profondeur (24 bits), du plus proche au plus loin. La
+ * profondeur est celle de l'origine de l'objet (la translation de sa
+ * matrice, que gl4du range par lignes) dans la vue de sa cible ; elle
+ * est nulle pour une cible sans vue. */
+static uint64_t key(const rqQueue_t * q, const rqItem_t * it) {
+  const GLfloat * m = it->matrix, * v;
+  GLfloat z = 0.0f;
+  if(it->target >= 0 && it->target < RQ_TARGETS && q->hasView[it->target]) {
+    v = q->views[it->target];
+    z = v[8] * m[3] + v[9] * m[7] + v[10] * m[11] + v[11];
+  }
+  return (uint64_t)(it->target & 0xFF) << 56 |
+    (uint64_t)(it->pId & 0xFFFF) << 40 |
+    (uint64_t)(it->tId & 0xFFFF) << 24 |
+    floatKey(-z) >> 8;
+}
+
+static int keyCmp(const void * a, const void * b) {
+  const rqKey_t * ka = (const rqKey_t *)a, * kb = (const rqKey_t *)b;
+  if(ka->key != kb->key)
+    return ka->key < kb->key ? -1 : 1;
+  return ka->item - kb->item;
+}
+
+/*!\brief renvoie une file vide dont les dessins copient la matrice
+ * \a matrix. */
+rqQueue_t * rqNew(const char * matrix) {
+  rqQueue_t * q = calloc(1, sizeof *q);
+  assert(q);
+  q->matrix = strdup(matrix);
+  assert(q->matrix);
+  return q;
+}
+
+/*!\brief copie \a view (16 flottants, matrice de vue gl4du) comme vue
+ * de la cible \a target : ses dessins seront triés du plus proche au
+ * plus loin dans cette vue. À refaire quand la vue change, avant
+ * rqFlush. */
+void rqView(rqQueue_t * q, int target, const GLfloat * view) {
+  assert(target >= 0 && target < RQ_TARGETS);
+  memcpy(q->views[target], view, sizeof q->views[target]);
+  q->hasView[target] = 1;
+}
+
+/*!\brief ajoute à \a q le dessin de \a mesh par \a pId avec \a tId sur
+ * l'unité 0, vers la cible \a target (voir rqFlush), avec la matrice
+ * \a matrix (16 flottants) ou, si elle est nulle, la matrice gl4du
+ * courante. Aucun appel GL : la file peut être remplie hors du contexte
+ * de dessin. */
+void rqSubmit(rqQueue_t * q, int target, GLuint mesh, GLuint pId, GLuint tId, const GLfloat * matrix) {
+  rqItem_t * it;
+  if(q->nbItems == q->size) {
+    q->size = q->size ? 2 * q->size : 16;
+    q->items = realloc(q->items, q->size * sizeof *q->items);
+    q->keys = realloc(q->keys, q->size * sizeof *q->keys);
+    assert(q->items && q->keys);
+  }
+  it = &q->items[q->nbItems++];
+  it->target = target;
+  it->mesh = mesh;
+  it->pId = pId;
+  it->tId = tId;
+  it->nbUniforms = 0;
+  memcpy(it->matrix, matrix ? matrix : gl4duGetMatrixData(), sizeof it->matrix);
+}
+
+/*!\brief renvoie une constante de plus pour le dernier dessin soumis. */
+static rqUniform_t * uniform(rqQueue_t * q, GLint loc) {
+  rqItem_t * it;
+  assert(q->nbItems);
+  it = &q->items[q->nbItems - 1];
+  assert(it->nbUniforms < RQ_UNIFORMS);
+  it->uniforms[it->nbUniforms].loc = loc;
+  return &it->uniforms[it->nbUniforms++];
+}
+
+/*!\brief fixe le vec4 en \a loc pour le dernier dessin soumis. */
+void rqUniform4fv(rqQueue_t * q, GLint loc, const GLfloat * v) {
+  rqUniform_t * u = uniform(q, loc);
+  u->isInt = 0;
+  memcpy(u->v, v, sizeof u->v);
+}
+
+/*!\brief fixe l'entier en \a loc pour le dernier dessin soumis. */
+void rqUniform1i(rqQueue_t * q, GLint loc, GLint v) {
+  rqUniform_t * u = uniform(q, loc);
+  u->isInt = 1;
+  u->i = v;
+}
+
+/*!\brief trie les dessins de \a q par clé puis les exécute et vide la
+ * file. \a target, si non nul, est appelé avec la cible de chaque
+ * groupe de dessins avant le premier d'entre eux (framebuffer, vue,
+ * faces cachées...). Les changements de programme et de texture
+ * passent par stateHelper et sont donc évités entre dessins voisins ;
+ * une constante propre à un dessin reste en place pour les dessins
+ * suivants du même programme qui ne la fixent pas. */
+void rqFlush(rqQueue_t * q, void (* target)(int)) {
+  int i, j, cur = -1;
+  for(i = 0; i < q->nbItems; i++) {
+    q->keys[i].key = key(q, &q->items[i]);
+    q->keys[i].item = i;
+  }
+  qsort(q->keys, q->nbItems, sizeof *q->keys, keyCmp);
+  gl4duBindMatrix(q->matrix);
+  gl4duPushMatrix();
+  for(i = 0; i < q->nbItems; i++) {
+    const rqItem_t * it = &q->items[q->keys[i].item];
+    if(it->target != cur) {
+      cur = it->target;
+      if(target) {
+        target(cur);
+        gl4duBindMatrix(q->matrix);
+      }
+    }
+    shUseProgram(it->pId);
+    shActiveTexture(GL_TEXTURE0);
+    shBindTexture(GL_TEXTURE_2D, it->tId);
+    for(j = 0; j < it->nbUniforms; j++)
+      if(it->uniforms[j].isInt)
+        glUniform1i(it->uniforms[j].loc, it->uniforms[j].i);
+      else
+        glUniform4fv(it->uniforms[j].loc, 1, it->uniforms[j].v);
+    gl4duLoadMatrixf(it->matrix);
+    gl4duSendMatrices();
+    gl4dgDraw(it->mesh);
+  }
+  gl4duPopMatrix();
+  q->nbItems = 0;
+}
+
+/*!\brief libère la file \a q. */
+void rqDelete(rqQueue_t * q) {
+  free(q->items);
+  free(q->keys);
+  free(q->matrix);
+  free(q);
+}
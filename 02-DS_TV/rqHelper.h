@@ -0,0 +1,25 @@
+#ifndef _RQ_HELPER_H
+
+#define _RQ_HELPER_H
+
+#include <GL4D/gl4du.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  typedef struct rqQueue_t rqQueue_t;
+
+  extern rqQueue_t * rqNew(const char * matrix);
+  extern void        rqView(rqQueue_t * q, int target, const GLfloat * view);
+  extern void        rqSubmit(rqQueue_t * q, int target, GLuint mesh, GLuint pId, GLuint tId, const GLfloat * matrix);
+  extern void        rqUniform4fv(rqQueue_t * q, GLint loc, const GLfloat * v);
+  extern void        rqUniform1i(rqQueue_t * q, GLint loc, GLint v);
+  extern void        rqFlush(rqQueue_t * q, void (* target)(int));
+  extern void        rqDelete(rqQueue_t * q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
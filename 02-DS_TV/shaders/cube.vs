@@ -2,8 +2,14 @@
 
 uniform mat4 modelViewMatrix;
 uniform mat4 projectionMatrix;
-uniform int time;          // temps
+/* valeurs communes de la frame (voir vhFrame) */
+layout (std140) uniform frame {
+  vec4  frResolution;
+  float frTime, frBasses, frAigus;
+};
 uniform int move;          // mode "mouvement des cubes"
+uniform int nbCubes;       // nombre de cubes de l'anneau
+uniform float spread;      // rayon de l'anneau
 uniform sampler2D cube;
 layout (location = 0) in vec3 vsiPosition;
 layout (location = 1) in vec3 vsiNormal;
@@ -12,15 +18,31 @@ layout (location = 2) in vec2 vsiTexCoord;
 out vec3 vsoNormal;
 out vec3 vsoModPos;
 
+#define PI 3.14159265359
+
+/* valeur pseudo-aléatoire dans [0, 1] tirée de l'entier x */
+float hash(uint x) {
+  x ^= x >> 16u; x *= 0x7feb352du;
+  x ^= x >> 15u; x *= 0x846ca68bu;
+  x ^= x >> 16u;
+  return float(x) / 4294967295.0;
+}
+
 void main(void) {
+  /* cube gl_InstanceID de l'anneau : angle régulier, profondeur dans
+   * [-13, -5] et taille dans [0, 0.05] pseudo-aléatoires */
+  uint id = uint(gl_InstanceID);
+  float a = 2.0 * PI * float(gl_InstanceID) / float(nbCubes);
+  vec3 c = vec3(spread * cos(a), spread * sin(a), -8.0 * hash(2u * id) - 5.0);
+  float s = 0.05 * hash(2u * id + 1u);
   vec3 vsiP = vsiPosition;
   /* mouvement des cubes en modifiant les vertices des cubes */
   if (vsiP.y > 0 && move != 0) {
-    vsiP.x += 1.5 * sin(time * 0.01);
+    vsiP.x += 1.5 * sin(frTime * 0.01);
   }
   vec2 uv = vec2(vsiTexCoord.x, 1.0 - vsiTexCoord.y);
   vec3 bpos = vsiP + 0.04 * texture(cube, uv).r * vsiP;
-  vec4 mp = modelViewMatrix * vec4(bpos, 1.0);
+  vec4 mp = modelViewMatrix * vec4(c + s * bpos, 1.0);
   vsoNormal = (transpose(inverse(modelViewMatrix))  * vec4(vsiNormal, 0.0)).xyz;
   vsoModPos = mp.xyz;
   gl_Position = projectionMatrix * mp;
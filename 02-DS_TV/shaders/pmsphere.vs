@@ -2,10 +2,13 @@
 
 uniform mat4 modelViewMatrix;
 uniform mat4 projectionMatrix;
-uniform int basses;      // basses
-uniform int pixel;       // mode "pixellisation"
+uniform int impostor;
 uniform int state;       // états de la démo
-uniform int time;        // temps
+/* valeurs communes de la frame (voir vhFrame) */
+layout (std140) uniform frame {
+  vec4  frResolution;
+  float frTime, frBasses, frAigus;
+};
 uniform sampler2D ebump;   
 layout (location = 0) in vec3 vsiPosition;
 layout (location = 1) in vec3 vsiNormal;
@@ -15,22 +18,50 @@ out vec3 vsoNormal;
 out vec3 vsoModPos;
 out vec2 vsoTexCoord;
 
+#ifdef INSTANCED
+layout (location = 3) in vec4 vsiInstance;
+layout (location = 4) in vec4 vsiColor;
+layout (location = 5) in float vsiLayer;
+flat out vec4 vsoColor;
+flat out float vsoLayer;
+#endif
+
 void main(void) {
+#ifdef INSTANCED
+  /* centre et rayon de l'instance, dans le repère de modelViewMatrix */
+  vec3 c = vsiInstance.xyz;
+  float r = vsiInstance.w;
+  vsoColor = vsiColor;
+  vsoLayer = vsiLayer;
+#else
+  vec3 c = vec3(0);
+  float r = 1.0;
+#endif
   vec3 vsiP = vsiPosition;
   float move;
   /* ondulation de la sphère */
-  if(pixel == 1) {
-    move = 0.0000004;
-  } else {
-    move = 0.04;
-    if(state < 0)
-      vsiP.xz += vsiP.xz * sin(basses * 10.0 * vsiP.y - 3.0 * time) * 0.05 * 1.0;
-  }
+#ifdef PIXEL
+  move = 0.0000004;
+#else
+  move = 0.04;
+  if(state < 0)
+    vsiP.xz += vsiP.xz * sin(frBasses * 10.0 * vsiP.y - 3.0 * frTime) * 0.05 * 1.0;
+#endif
 
   vsoTexCoord = vec2(vsiTexCoord.x, 1.0 - vsiTexCoord.y);
-  vec3 bpos = vsiP + basses * move * texture(ebump, vsoTexCoord).r * vsiNormal;
-  vec4 mp = modelViewMatrix * vec4(bpos, 1.0);
+#ifdef PACMAN
+  vec3 bpos = vsiP + frBasses * move * texture(ebump, vsoTexCoord).a * vsiNormal;
+#else
+  /* les étoiles n'ont pas de carte de hauteur */
+  vec3 bpos = vsiP;
+#endif
+  vec4 mp = modelViewMatrix * vec4(c + r * bpos, 1.0);
   vsoNormal = (transpose(inverse(modelViewMatrix))  * vec4(vsiNormal, 0.0)).xyz;
+  /* imposteur : quadrilatère face à la caméra, du rayon de la sphère */
+  if(impostor != 0) {
+    mp = modelViewMatrix * vec4(c, 1) + vec4(r * length(modelViewMatrix[0].xyz) * vsiPosition.xy, 0, 0);
+    vsoNormal = vec3(0, 0, 1);
+  }
   vsoModPos = mp.xyz;
   gl_Position = projectionMatrix * mp;
 }
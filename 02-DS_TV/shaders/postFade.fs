@@ -0,0 +1,9 @@
+#version 330
+uniform sampler2D tex;
+uniform float param;       // fondu, 1 pour du noir
+in  vec2 vsoTexCoord;
+out vec4 fragColor;
+
+void main(void) {
+  fragColor = mix(texture(tex, vsoTexCoord), vec4(0, 0, 0, 1), clamp(param, 0.0, 1.0));
+}
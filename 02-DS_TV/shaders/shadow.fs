@@ -1,10 +1,9 @@
 #version 330 core
-uniform int id;           // identifiant
 uniform int state;        // états de la démo
 uniform int time;         // temps
 uniform vec4 couleur;     // couleur
 uniform vec4 lumpos;      // lumière
-uniform sampler2D smTex;
+uniform sampler2DShadow smTex;
 in  vec4 vsoNormal;
 in  vec4 vsoMVPos;
 in  vec4 vsoSMCoord;
@@ -12,6 +11,24 @@ in  vec2 vsoTexCoord;
 layout (location = 0) out vec4 fragColor;
 layout (location = 1) out vec4 fragId;
 
+/* identifiant de l'objet, fixé à la compilation de chaque variante */
+#ifndef ID
+#define ID 0
+#endif
+
+/* part éclairée en p (coordonnées de la shadow map) : moyenne de 3x3
+ * comparaisons, chacune filtrée sur 2x2 texels (GL_LINEAR) */
+float lit(vec3 p) {
+  vec2 texel = 1.0 / vec2(textureSize(smTex, 0));
+  float s = 0.0;
+  if(p.z > 1.0)
+    return 1.0;
+  for(int i = -1; i <= 1; i++)
+    for(int j = -1; j <= 1; j++)
+      s += texture(smTex, vec3(p.xy + vec2(i, j) * texel, p.z));
+  return s / 9.0;
+}
+
 /* création d'un anneau */
 float ring(vec2 p) {
     float r = log(sqrt(length(p)));
@@ -19,51 +36,50 @@ float ring(vec2 p) {
 }
 
 void main(void) {
+#if ID == 2
   /* dessine le cercle en jaune pour le soleil (id = 2) */
-  if(id == 2) {
-    fragColor = vec4(1, 1, 0.5, 1);
+  fragColor = vec4(1, 1, 0.5, 1);
+#elif ID == 4
   /* dessine le cercle en gris pour le nuage (id = 4) */
-  } else if(id == 4) {
-    fragColor = vec4(0.5, 0.5, 0.5, 1);
-  } else {
-    vec3 N = normalize(vsoNormal.xyz);
-    vec3 L = normalize(vsoMVPos.xyz - lumpos.xyz);
-    vec3 projCoords = vsoSMCoord.xyz / vsoSMCoord.w;
-    float diffuse = dot(N, -L);
-    if(id != 1) {
-      if(diffuse < 0.3)
-        diffuse = 0.1;
-      else if(diffuse < 0.6)
-        diffuse = 0.5;
-      else if(diffuse < 0.9)
-        diffuse = 0.75;
-      else
-        diffuse = 1.0;
-    }
-    if(texture(smTex, projCoords.xy).r  <  projCoords.z)
-      diffuse *= 0.0;
-      
-    /* dessine la texture uniquement */
-    if(state < 3)
-      fragColor = vec4((couleur.rgb), couleur.a);
-    /* dessine la texture avec la diffuse */
-    else
-      fragColor = vec4((couleur.rgb * diffuse), couleur.a);
-    /* dessine des anneaux progressives sur le cercle (id = 3) */
-    if(id == 3) {
-      vec2 uv = (vsoTexCoord - 0.5);
-      vec3 color = vec3(0.0);
-      float rz = 1.0;
-      uv /= exp(mod(time * 3.15, 1.0));
-      rz *= abs(ring(uv));
-      color = vec3(rz)  + vec3(1.0, 1.0, 1.0);
-      if(state < 1) 
-        fragColor = vec4((couleur.rgb), couleur.a);
-      else if(state >= 1 && state <= 3)
-        fragColor = vec4((couleur.rgb * diffuse), couleur.a);
-      else {
-        fragColor = mix(vec4((couleur.rgb * diffuse), couleur.a), vec4(color, 1.0), smoothstep(.1, .009, rz));
-      }
-    }
+  fragColor = vec4(0.5, 0.5, 0.5, 1);
+#else
+  vec3 N = normalize(vsoNormal.xyz);
+  vec3 L = normalize(vsoMVPos.xyz - lumpos.xyz);
+  vec3 projCoords = vsoSMCoord.xyz / vsoSMCoord.w;
+  float diffuse = dot(N, -L);
+#if ID != 1
+  if(diffuse < 0.3)
+    diffuse = 0.1;
+  else if(diffuse < 0.6)
+    diffuse = 0.5;
+  else if(diffuse < 0.9)
+    diffuse = 0.75;
+  else
+    diffuse = 1.0;
+#endif
+  diffuse *= lit(projCoords);
+#if ID == 3
+  /* dessine des anneaux progressives sur le cercle (id = 3) */
+  vec2 uv = (vsoTexCoord - 0.5);
+  vec3 color = vec3(0.0);
+  float rz = 1.0;
+  uv /= exp(mod(time * 3.15, 1.0));
+  rz *= abs(ring(uv));
+  color = vec3(rz)  + vec3(1.0, 1.0, 1.0);
+  if(state < 1) 
+    fragColor = vec4((couleur.rgb), couleur.a);
+  else if(state >= 1 && state <= 3)
+    fragColor = vec4((couleur.rgb * diffuse), couleur.a);
+  else {
+    fragColor = mix(vec4((couleur.rgb * diffuse), couleur.a), vec4(color, 1.0), smoothstep(.1, .009, rz));
   }
+#else
+  /* dessine la texture uniquement */
+  if(state < 3)
+    fragColor = vec4((couleur.rgb), couleur.a);
+  /* dessine la texture avec la diffuse */
+  else
+    fragColor = vec4((couleur.rgb * diffuse), couleur.a);
+#endif
+#endif
 }
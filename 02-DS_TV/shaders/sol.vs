@@ -3,7 +3,11 @@
 uniform mat4 modelViewMatrix;
 uniform mat4 projectionMatrix;
 uniform float amplitude;   // amplitude
-uniform uint frame;        // temps
+/* valeurs communes de la frame (voir vhFrame) */
+layout (std140) uniform frame {
+  vec4  frResolution;
+  float frTime, frBasses, frAigus;
+};
 uniform vec2 step;         // pas
 uniform sampler2D tex;
 layout (location = 0) in vec3 vsiPosition;
@@ -12,7 +16,7 @@ layout (location = 2) in vec2 vsiTexCoord;
 
 out vec3 vsoNormal;
 
-float dephase = float(frame) / 250.0;
+float dephase = frTime / 250.0;
 
 float height(vec2 p) {
   const float level = 1.5;
@@ -1,7 +1,6 @@
 #version 330
 uniform int basses;  // basses
 uniform int time;    // temps
-uniform int wave;    // mode "wave" pour "représentation graphique"
 uniform float line;  // nombre de lignes pour la construction du cercle
 in  vec2 vsoTexCoord;
 out vec4 fragColor;
@@ -23,7 +22,9 @@ void main(void) {
   vec4 colorCercle = vec4(1.0 - c, 0.0);
   fragColor += colorCercle;
 
-  if(wave != 0) {
+#ifdef WAVE
+  /* mode "wave" pour "représentation graphique" */
+  {
     /* création des ondes qui varient selon la musique */
     const float speed = .000001;
     const float rate = 15.0;
@@ -38,11 +39,14 @@ void main(void) {
     float pulse = exp(-10000.0 * z);
     vec4 colorWave = vec4(1.0, 1.0, 1.0, 1.0) * pow(clamp(1.0-abs(pos.y-(amp * base + pulse - 0.5)), 0.0, 1.0), 12.0);
     fragColor += colorWave;
-  } else {
+  }
+#else
+  {
     /* création du cercle (non remplie) dont les extrémités seront ondulées selon la musique */
     pos = vec2(basses / 4.0) - vsoTexCoord * (basses / 2.0);
     float u = sin((atan(pos.y, pos.x) + time * 0.003) * basses / 2.0) * 0.005 * basses;
     float t = 0.01 * abs(sin(time)) * 5.0 / abs(0.5 + u - length(pos));
     fragColor = mix(colorCercle, vec4(vec3(t), 1.0), 0.1);
   }
+#endif
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <GL4D/gl4df.h>
 #include <GL4D/gl4du.h>
@@ -8,6 +9,10 @@
 #include <SDL_mixer.h>
 #include <GL4D/gl4duw_SDL2.h>
 #include "audioHelper.h"
+#include "variantHelper.h"
+#include "stateHelper.h"
+#include "rqHelper.h"
+#include "mxHelper.h"
 
 
 #define EPSILON 0.00001f
@@ -17,9 +22,10 @@ static void   init(int w, int h);
 static void   mobileInit(GLfloat width, GLfloat depth);
 static double get_dt(void);
 static void   mobileMove(void);
-static void   mobileDraw(GLuint obj);
 static void   draw(void);
 static void   quit(void);
+static int    fitLight(void);
+static void   composite(void);
 
 /* !\brief structure représentant un cercle */
 typedef struct mobile_t mobile_t;
@@ -35,16 +41,53 @@ static GLuint _screen = 0;
 static int _w, _h;
 /* !\brief basses de la démo */
 static int _basses = 0;
-/*!\brief identifiant du programme GLSL */
-static GLuint _shPID = 0;
+/*!\brief variantes du programme GLSL, une par objet (ID) */
+enum { SH_PLAN = 1, SH_SOLEIL, SH_CERCLE, SH_NUAGE, SH_NB };
+static GLuint _shPID[SH_NB] = {0};
+/*!\brief emplacements des uniforms de chaque variante */
+enum { U_COULEUR = 0, U_SMTEX, U_LUMPOS, U_TIME, U_STATE, U_NB };
+static const char * const _uNames[U_NB] = { "couleur", "smTex", "lumpos", "time", "state" };
+static GLint _u[SH_NB][U_NB];
+/*!\brief passes de rendu, cibles des dessins de la file : ombrants
+ * statiques (seulement quand leur cache est à refaire), ombrants
+ * dynamiques puis image */
+enum { PASS_SHADOW_STATIC = 0, PASS_SHADOW_MAP, PASS_SCENE };
+/*!\brief ombre portée d'un objet : aucune, fixe (gardée en cache) ou
+ * redessinée à chaque frame */
+enum { SHADOW_NONE = 0, SHADOW_STATIC, SHADOW_DYNAMIC };
+/*!\brief file des dessins des deux passes */
+static rqQueue_t * _queue = NULL;
+/*!\brief nombre maximal d'objets : soleil, trois nuages, plan et cercle */
+#define NB_OBJECTS 6
+/*!\brief un objet de la scène (voir object) */
+typedef struct object_t object_t;
+struct object_t {
+  GLuint mesh;
+  int id, shadow;
+  const GLfloat * color;
+};
+/*!\brief objets de la frame et leurs transformations */
+static object_t _objects[NB_OBJECTS];
+static mxTRS_t _trs[NB_OBJECTS];
+/*!\brief matrice (mxHelper) dont dérivent les matrices modèle */
+static int _world = -1;
 /*!\brief identifiant du programme GLSL pour la shadow map */
 static GLuint _smPID = 0;
 /*!\brief couleur de la texture */
 static GLuint _colorTex = 0;
 /*!\brief profondeur de la texture */
 static GLuint _depthTex = 0;
-/*!\brief texture pour la shadow map */
+/*!\brief texture pour la shadow map, lue avec comparaison (PCF) */
 static GLuint _smTex = 0;
+/*!\brief profondeur des seuls ombrants statiques, son framebuffer,
+ * s'il faut la refaire (lumière ou frustum modifiés) et le nombre
+ * d'ombrants qu'elle contient */
+static GLuint _smStaticTex = 0, _smFbo = 0;
+static int _smDirty = 1, _smStatics = 0;
+/*!\brief vrai quand _smTex a reçu le cache statique dans la frame */
+static int _smComposited = 0;
+/*!\brief vue et frustum de la lumière ayant servi au cache */
+static GLfloat _lightKey[16 + 6];
 /*!\brief identifiant de la texture */
 static GLuint _idTex = 0;
 /*!\brief identifiant de la sphère de GL4Dummies */
@@ -76,11 +119,19 @@ static int _state = 0;
 
 /*!\brief initialise les paramètres OpenGL et les données */
 static void init(int w, int h) {
+  int i;
+  const GLfloat border[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+  GLuint fbo = shFramebuffer(GL_DRAW_FRAMEBUFFER);
   _w = w;
   _h = h;
-  glEnable(GL_DEPTH_TEST);
-  _shPID  = gl4duCreateProgram("<vs>shaders/shadow.vs", "<fs>shaders/shadow.fs", NULL);
-  _smPID  = gl4duCreateProgram("<vs>shaders/shadowMap.vs", "<fs>shaders/shadowMap.fs", NULL);
+  shEnable(GL_DEPTH_TEST);
+  for(i = SH_PLAN; i < SH_NB; i++) {
+    char defines[32];
+    sprintf(defines, "#define ID %d\n", i);
+    _shPID[i] = vhProgram("shaders/shadow.vs", "shaders/shadow.fs", defines);
+    vhUniforms(_shPID[i], _uNames, U_NB, _u[i]);
+  }
+  _smPID  = vhProgram("shaders/shadowMap.vs", "shaders/shadowMap.fs", NULL);
   gl4duGenMatrix(GL_FLOAT, "modelMatrix");
   gl4duGenMatrix(GL_FLOAT, "lightViewMatrix");
   gl4duGenMatrix(GL_FLOAT, "lightProjectionMatrix");
@@ -88,9 +139,6 @@ static void init(int w, int h) {
   gl4duGenMatrix(GL_FLOAT, "cameraProjectionMatrix");
   gl4duGenMatrix(GL_FLOAT, "cameraPVMMatrix");
 
-  gl4duBindMatrix("lightProjectionMatrix");
-  gl4duLoadIdentityf();
-  gl4duFrustumf(-1, 1, -1, 1, 1.5, 50.0);
   gl4duBindMatrix("cameraProjectionMatrix");
   gl4duLoadIdentityf();
   gl4duFrustumf(-0.5, 0.5, -0.5 * _h / _w, 0.5 * _h / _w, 1.0, 50.0);
@@ -98,33 +146,56 @@ static void init(int w, int h) {
 
   _sphere = gl4dgGenSpheref(30, 30);
   _quad = gl4dgGenQuadf();
+  _queue = rqNew("modelMatrix");
+  if(_world < 0)
+    _world = mxGen();
   mobileInit(_plan_s, _plan_s);
 
+  /* comparaison matérielle filtrée (2x2) ; hors de la carte, pas
+   * d'ombre */
   glGenTextures(1, &_smTex);
-  glBindTexture(GL_TEXTURE_2D, _smTex);
+  shBindTexture(GL_TEXTURE_2D, _smTex);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+  glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_MAP_SIDE, SHADOW_MAP_SIDE, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+
+  glGenTextures(1, &_smStaticTex);
+  shBindTexture(GL_TEXTURE_2D, _smStaticTex);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_MAP_SIDE, SHADOW_MAP_SIDE, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
 
   glGenTextures(1, &_colorTex);
-  glBindTexture(GL_TEXTURE_2D, _colorTex);
+  shBindTexture(GL_TEXTURE_2D, _colorTex);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _w, _h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 
   glGenTextures(1, &_depthTex);
-  glBindTexture(GL_TEXTURE_2D, _depthTex);
+  shBindTexture(GL_TEXTURE_2D, _depthTex);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, _w, _h, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE, NULL);
 
   glGenTextures(1, &_idTex);
-  glBindTexture(GL_TEXTURE_2D, _idTex);
+  shBindTexture(GL_TEXTURE_2D, _idTex);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, _w, _h, 0, GL_RED, GL_UNSIGNED_INT, NULL);
 
   glGenFramebuffers(1, &_fbo);
+  glGenFramebuffers(1, &_smFbo);
+  shBindFramebuffer(GL_FRAMEBUFFER, _smFbo);
+  glDrawBuffer(GL_NONE);
+  glReadBuffer(GL_NONE);
+  shFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, _smStaticTex, 0);
+  shBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  _smDirty = 1;
 }
 
 /*!\brief initialise des données du cercle */
@@ -141,71 +212,220 @@ static void mobileInit(GLfloat width, GLfloat depth) {
   _mobile.color[3] = 1.0f;
 }
 
-/*!\brief dessine la scène de la démo */
-static void scene(GLboolean sm) {
-  glEnable(GL_CULL_FACE);
-  int i;
+/*!\brief range l'objet \a n : \a mesh dessiné dans l'image avec la
+ * variante \a id et, s'il porte une ombre (\a shadow, SHADOW_STATIC ou
+ * SHADOW_DYNAMIC), dans la shadow map ; \a color, si non nul, est sa couleur propre. Sa matrice modèle
+ * est translation (\a x, \a y, \a z) * rotation de \a angle degrés
+ * autour de x * échelle (\a sx, \a sy, \a sz). Renvoie n + 1. */
+static int object(int n, GLuint mesh, int id, int shadow, const GLfloat * color,
+                  GLfloat x, GLfloat y, GLfloat z, GLfloat angle, GLfloat sx, GLfloat sy, GLfloat sz) {
+  mxTRS_t * t = &_trs[n];
+  assert(n < NB_OBJECTS);
+  _objects[n].mesh = mesh;
+  _objects[n].id = id;
+  _objects[n].shadow = shadow;
+  _objects[n].color = color;
+  t->t[0] = x; t->t[1] = y; t->t[2] = z;
+  t->angle = angle;
+  t->axis[0] = 1.0f; t->axis[1] = 0.0f; t->axis[2] = 0.0f;
+  t->s[0] = sx; t->s[1] = sy; t->s[2] = sz;
+  return n + 1;
+}
+
+/*!\brief prépare les deux passes (vues, paramètres communs) et remplit
+ * la file avec la scène de la démo */
+static void scene(void) {
+  int i, n = 0;
   int time = SDL_GetTicks();
-  GLfloat white[] = {255, 255, 255, 0}, lp[4];
-  /* dessine la shadow map */
-  if(sm) {
-    glCullFace(GL_FRONT);
-    glUseProgram(_smPID);
-    gl4duBindMatrix("lightViewMatrix");
-    gl4duLoadIdentityf();
-    gl4duLookAtf(_lumpos[0], _lumpos[1], _lumpos[2], 0, 2, 0, 0, 1, 0);
-    gl4duBindMatrix("modelMatrix");
-    gl4duLoadIdentityf();
-  } else {
-    GLfloat *mat;
-    glCullFace(GL_BACK);
-    glUseProgram(_shPID);
-    glEnable(GL_TEXTURE_2D);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _smTex);
-    glUniform1i(glGetUniformLocation(_shPID, "smTex"), 0);
-    gl4duBindMatrix("cameraViewMatrix");
-    gl4duLoadIdentityf();
-    gl4duLookAtf(0, 4, 22, 0, 2, 0, 0, 1, 0);
-    /* dessine la lumière positionnelle */
-    mat = gl4duGetMatrixData();
-    MMAT4XVEC4(lp, mat, _lumpos);
-    MVEC4WEIGHT(lp);
-    glUniform4fv(glGetUniformLocation(_shPID, "lumpos"), 1, lp);
-    gl4duBindMatrix("modelMatrix");
-    gl4duLoadIdentityf();
-    gl4duPushMatrix(); {
-      gl4duTranslatef(_lumpos[0], _lumpos[1], _lumpos[2]);
-      gl4duScalef(0.5, 0.5, 0.5);
-      gl4duSendMatrices();
-    } gl4duPopMatrix();
-    glUniform1i(glGetUniformLocation(_shPID, "id"), 2);
-    glUniform1i(glGetUniformLocation(_shPID, "time"), time);
-    if(_state >= 3) gl4dgDraw(_sphere);
-
-    /* dessine les nuages */
-    for(i = 0; i < 3; i++) {
-      gl4duPushMatrix(); {
-        gl4duTranslatef(_cloudpos[i][0], _cloudpos[i][1], _cloudpos[i][2]);
-        gl4duScalef(1.2, 0.18, 0.3);
-        gl4duSendMatrices();
-      } gl4duPopMatrix();
-      glUniform1i(glGetUniformLocation(_shPID, "id"), 4);
-      glUniform1i(glGetUniformLocation(_shPID, "time"), time);
-      if(_state >= 4) gl4dgDraw(_sphere);
+  GLfloat white[] = {255, 255, 255, 0}, lp[4], * mat, models[16 * NB_OBJECTS];
+  gl4duBindMatrix("lightViewMatrix");
+  gl4duLoadIdentityf();
+  gl4duLookAtf(_lumpos[0], _lumpos[1], _lumpos[2], 0, 2, 0, 0, 1, 0);
+  gl4duBindMatrix("cameraViewMatrix");
+  gl4duLoadIdentityf();
+  gl4duLookAtf(0, 4, 22, 0, 2, 0, 0, 1, 0);
+  if(fitLight())
+    _smDirty = 1;
+  /* vues des passes, pour trier leurs dessins du plus proche au plus loin */
+  gl4duBindMatrix("lightViewMatrix");
+  rqView(_queue, PASS_SHADOW_STATIC, gl4duGetMatrixData());
+  rqView(_queue, PASS_SHADOW_MAP, gl4duGetMatrixData());
+  gl4duBindMatrix("cameraViewMatrix");
+  rqView(_queue, PASS_SCENE, gl4duGetMatrixData());
+  /* dessine la lumière positionnelle */
+  mat = gl4duGetMatrixData();
+  MMAT4XVEC4(lp, mat, _lumpos);
+  MVEC4WEIGHT(lp);
+  /* paramètres communs à toutes les variantes */
+  for(i = SH_PLAN; i < SH_NB; i++) {
+    shUseProgram(_shPID[i]);
+    glUniform1i(_u[i][U_SMTEX], 0);
+    glUniform4fv(_u[i][U_LUMPOS], 1, lp);
+    glUniform1i(_u[i][U_TIME], time);
+    glUniform1i(_u[i][U_STATE], _state);
+  }
+  /* les matrices modèle de tous les objets, composées en un appel */
+  if(_state >= 3)
+    n = object(n, _sphere, SH_SOLEIL, 0, NULL, _lumpos[0], _lumpos[1], _lumpos[2], 0, 0.5, 0.5, 0.5);
+  /* dessine les nuages */
+  if(_state >= 4)
+    for(i = 0; i < 3; i++)
+      n = object(n, _sphere, SH_NUAGE, 0, NULL, _cloudpos[i][0], _cloudpos[i][1], _cloudpos[i][2], 0, 1.2, 0.18, 0.3);
+  /* dessine le plan : il reçoit les ombres mais, face à la lumière, est
+   * éliminé par le culling des faces avant de la shadow map */
+  n = object(n, _quad, SH_PLAN, SHADOW_NONE, white, 0, 0, 0, -90, _plan_s, _plan_s, _plan_s);
+  /* dessine le cercle */
+  n = object(n, _sphere, SH_CERCLE, SHADOW_DYNAMIC, _mobile.color, _mobile.x, _mobile.y, _mobile.z, 0, _mobile.r, _mobile.r, _mobile.r);
+  mxCompose(_world, n, _trs, models);
+  if(_smDirty)
+    _smStatics = 0;
+  for(i = 0; i < n; i++) {
+    if(_objects[i].shadow == SHADOW_STATIC && _smDirty) {
+      rqSubmit(_queue, PASS_SHADOW_STATIC, _objects[i].mesh, _smPID, 0, &models[16 * i]);
+      _smStatics++;
+    } else if(_objects[i].shadow == SHADOW_DYNAMIC)
+      rqSubmit(_queue, PASS_SHADOW_MAP, _objects[i].mesh, _smPID, 0, &models[16 * i]);
+    rqSubmit(_queue, PASS_SCENE, _objects[i].mesh, _shPID[_objects[i].id], _smTex, &models[16 * i]);
+    if(_objects[i].color)
+      rqUniform4fv(_queue, _u[_objects[i].id][U_COULEUR], _objects[i].color);
+  }
+  _smDirty = 0;
+}
+
+/*!\brief découpe le polygone convexe \a p de \a n sommets (x, y, z
+ * monde puis x, y, z, w de découpage) par le plan \a s * c[\a axis] <=
+ * w, c étant les coordonnées de découpage.
+ * \return le nombre de sommets écrits dans \a out.
+ */
+static int clip(GLfloat (* p)[7], int n, int axis, GLfloat s, GLfloat (* out)[7]) {
+  int i, k, m = 0;
+  for(i = 0; i < n; i++) {
+    const GLfloat * a = p[i], * b = p[(i + 1) % n];
+    GLfloat da = a[6] - s * a[3 + axis], db = b[6] - s * b[3 + axis];
+    if(da >= 0.0f)
+      memcpy(out[m++], a, sizeof *out);
+    if((da >= 0.0f) != (db >= 0.0f)) {
+      for(k = 0; k < 7; k++)
+        out[m][k] = a[k] + da / (da - db) * (b[k] - a[k]);
+      m++;
     }
   }
+  return m;
+}
 
-  /* dessine le plan */
-  gl4duPushMatrix(); {
-    gl4duRotatef(-90, 1, 0, 0);
-    gl4duScalef(_plan_s, _plan_s, _plan_s);
-    gl4duSendMatrices();
-  } gl4duPopMatrix();
-  glUniform1i(glGetUniformLocation(_shPID, "id"), 1);
-  glUniform4fv(glGetUniformLocation(_shPID, "couleur"), 1, white);
-  gl4dgDraw(_quad);  
-  mobileDraw(_sphere);
+/*!\brief ajuste "lightProjectionMatrix" à la partie du plan vue par la
+ * caméra, seul receveur étendu : le plan est découpé par le volume de
+ * vue puis ses sommets, vus de la lumière, bornent le frustum, sans
+ * jamais dépasser l'ancien (90 degrés, near 1.5, far 50). Les ombrants
+ * plus proches que near sont écrasés sur lui (GL_DEPTH_CLAMP, voir
+ * pass).
+ * \return 1 si la vue ou le frustum de la lumière ont changé depuis le
+ * dernier appel.
+ */
+static int fitLight(void) {
+  static const GLfloat corners[4][2] = { {-1, -1}, {1, -1}, {1, 1}, {-1, 1} };
+  GLfloat poly[2][4 + 6][7], v[4], w[4], c[4], key[16 + 6], d, zmin = 50.0f, zmax = 0.0f;
+  GLfloat box[4] = { 1.0f, -1.0f, 1.0f, -1.0f }, * cv, * cp, * lv;
+  int i, n = 4, src = 0;
+  gl4duBindMatrix("cameraViewMatrix");
+  cv = gl4duGetMatrixData();
+  gl4duBindMatrix("cameraProjectionMatrix");
+  cp = gl4duGetMatrixData();
+  gl4duBindMatrix("lightViewMatrix");
+  lv = gl4duGetMatrixData();
+  for(i = 0; i < 4; i++) {
+    v[0] = corners[i][0] * _plan_s; v[1] = 0.0f; v[2] = corners[i][1] * _plan_s; v[3] = 1.0f;
+    memcpy(poly[0][i], v, 3 * sizeof *v);
+    MMAT4XVEC4(w, cv, v);
+    MMAT4XVEC4(c, cp, w);
+    memcpy(&poly[0][i][3], c, 4 * sizeof *c);
+  }
+  for(i = 0; i < 6 && n; i++, src = !src)
+    n = clip(poly[src], n, i / 2, i % 2 ? -1.0f : 1.0f, poly[!src]);
+  for(i = 0; i < n; i++) {
+    memcpy(v, poly[src][i], 3 * sizeof *v);
+    v[3] = 1.0f;
+    MMAT4XVEC4(w, lv, v);
+    zmin = MIN(zmin, d = -w[2]);
+    zmax = MAX(zmax, d);
+    if(d <= EPSILON) {
+      /* sommet au niveau de la lumière : pas de borne */
+      box[0] = box[2] = -1.0f;
+      box[1] = box[3] = 1.0f;
+      continue;
+    }
+    box[0] = MIN(box[0], w[0] / d); box[1] = MAX(box[1], w[0] / d);
+    box[2] = MIN(box[2], w[1] / d); box[3] = MAX(box[3], w[1] / d);
+  }
+  if(!n) {
+    box[0] = box[2] = -1.0f;
+    box[1] = box[3] = 1.0f;
+    zmax = 50.0f;
+  }
+  for(i = 0; i < 4; i++)
+    box[i] = MIN(MAX(box[i], -1.0f), 1.0f);
+  key[16 + 4] = MAX(zmin, 1.5f);
+  key[16 + 5] = MIN(MAX(zmax * 1.01f, key[16 + 4] + 1.0f), 50.0f);
+  for(i = 0; i < 4; i++)
+    key[16 + i] = box[i] * key[16 + 4];
+  memcpy(key, lv, 16 * sizeof *key);
+  gl4duBindMatrix("lightProjectionMatrix");
+  gl4duLoadIdentityf();
+  gl4duFrustumf(key[16], key[17], key[18], key[19], key[20], key[21]);
+  if(!memcmp(key, _lightKey, sizeof key))
+    return 0;
+  memcpy(_lightKey, key, sizeof key);
+  return 1;
+}
+
+/*!\brief recopie dans _smTex la profondeur des ombrants statiques,
+ * ou l'efface simplement si le cache n'en contient aucun, et y laisse
+ * le framebuffer prêt pour les ombrants dynamiques. */
+static void composite(void) {
+  shBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+  glDrawBuffer(GL_NONE);
+  shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+  shFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, _smTex, 0);
+  if(_smStatics) {
+    shBindFramebuffer(GL_READ_FRAMEBUFFER, _smFbo);
+    glBlitFramebuffer(0, 0, SHADOW_MAP_SIDE, SHADOW_MAP_SIDE, 0, 0, SHADOW_MAP_SIDE, SHADOW_MAP_SIDE, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    shBindFramebuffer(GL_READ_FRAMEBUFFER, _fbo);
+  } else
+    glClear(GL_DEPTH_BUFFER_BIT);
+  _smComposited = 1;
+}
+
+/*!\brief prépare la cible \a pass avant ses dessins (voir rqFlush) */
+static void pass(int pass) {
+  GLenum renderings[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+  if(pass == PASS_SHADOW_STATIC || pass == PASS_SHADOW_MAP) {
+    if(pass == PASS_SHADOW_STATIC) {
+      shBindFramebuffer(GL_FRAMEBUFFER, _smFbo);
+      glClear(GL_DEPTH_BUFFER_BIT);
+    } else
+      composite();
+    shViewport(0, 0, SHADOW_MAP_SIDE, SHADOW_MAP_SIDE);
+    shEnable(GL_DEPTH_CLAMP);
+    glCullFace(GL_FRONT);
+    return;
+  }
+  if(!_smComposited)
+    composite();
+  shDisable(GL_DEPTH_CLAMP);
+  shBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+  shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _colorTex, 0);
+  shFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, _idTex, 0);
+  shFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, _depthTex, 0);
+  shViewport(0, 0, _w, _h);
+
+  glDrawBuffers(1, &renderings[1]);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  glDrawBuffers(1, renderings);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  glDrawBuffers(2, renderings);
+  glCullFace(GL_BACK);
 }
 
 /*!\brief calcule le mouvement des cercles */
@@ -278,55 +498,23 @@ static void draw(void) {
   }
 
   mobileMove();
-  GLenum renderings[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
-  glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
-
-  glDrawBuffer(GL_NONE);
-  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
-  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, _smTex, 0);
-
-  glViewport(0, 0, SHADOW_MAP_SIDE, SHADOW_MAP_SIDE);
-  glClear(GL_DEPTH_BUFFER_BIT);
-  scene(GL_TRUE);
-
-  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _colorTex, 0);
-  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, _idTex, 0);
-  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, _depthTex, 0);
-  glViewport(0, 0, _w, _h);
-
-  glDrawBuffers(1, &renderings[1]);
-  glClear(GL_COLOR_BUFFER_BIT);
-
-  glDrawBuffers(1, renderings);
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-  glDrawBuffers(2, renderings);
-
-  scene(GL_FALSE);
-
-
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  /* la cible (l'écran ou le framebuffer d'une transition) et sa vue,
+   * remises en place après le rendu */
+  GLuint target = shFramebuffer(GL_DRAW_FRAMEBUFFER);
+  GLint vp[4];
+  shGetViewport(vp);
+  scene();
+  shEnable(GL_CULL_FACE);
+  _smComposited = 0;
+  rqFlush(_queue, pass);
+
+  shBindFramebuffer(GL_DRAW_FRAMEBUFFER, target);
+  shViewport(vp[0], vp[1], vp[2], vp[3]);
   glBlitFramebuffer(0, 0, _w, _h, 0, 0, _w, _h, GL_COLOR_BUFFER_BIT, GL_LINEAR);
   glBlitFramebuffer(0, 0, _w, _h, 0, 0, _w, _h, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
   glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 }
 
-/*!\brief dessine les cercles. */
-static void mobileDraw(GLuint obj) {
-  GLint pId;
-  glGetIntegerv(GL_CURRENT_PROGRAM, &pId);
-  gl4duPushMatrix();
-  gl4duTranslatef(_mobile.x, _mobile.y, _mobile.z);
-  gl4duScalef(_mobile.r, _mobile.r, _mobile.r);
-  gl4duSendMatrices();
-  gl4duPopMatrix();
-  glUniform1i(glGetUniformLocation(pId, "id"), 3);
-  glUniform4fv(glGetUniformLocation(pId, "couleur"), 1, _mobile.color);
-  glUniform1i(glGetUniformLocation(pId, "state"), _state);
-
-  gl4dgDraw(obj);
-}
-
 /* !\brief libère les éléments OpenGL utilisés */
 static void quit(void) {
   if(_fbo) {
@@ -334,8 +522,14 @@ static void quit(void) {
     glDeleteTextures(1, &_depthTex);
     glDeleteTextures(1, &_idTex);
     glDeleteTextures(1, &_smTex);
+    glDeleteTextures(1, &_smStaticTex);
     glDeleteFramebuffers(1, &_fbo);
-    _fbo = 0;
+    glDeleteFramebuffers(1, &_smFbo);
+    _fbo = _smFbo = 0;
+  }
+  if(_queue) {
+    rqDelete(_queue);
+    _queue = NULL;
   }
   if(_screen) {
     gl4dpSetScreen(_screen);
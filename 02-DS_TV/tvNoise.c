@@ -7,6 +7,7 @@
 #include <GL4D/gl4dh.h>
 #include <GL4D/gl4dp.h>
 #include "audioHelper.h"
+#include "stateHelper.h"
 
 static void quit(void);
 static void init(int w, int h);
@@ -61,6 +62,7 @@ void tvNoise(int state) {
     default:
       draw();
       gl4dpUpdateScreen(NULL);
+      shInvalidate(SH_PROGRAM_BIT | SH_TEXTURE_BIT | SH_ENABLE_BIT);
       return;
   }
 }
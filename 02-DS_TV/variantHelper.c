@@ -0,0 +1,406 @@
+#include "variantHelper.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#  include <direct.h>
+#  define mkdir(d, m) _mkdir(d)
+#endif
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#  define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+/*!\brief dossier où sont rangés les programmes déjà liés */
+#define VH_CACHE_DIR "cache"
+/*!\brief point de liaison du bloc "frame" (voir vhFrame) */
+#define VH_FRAME_BINDING 0
+
+/*!\brief une variante : le couple de shaders, les définitions
+ * injectées et le programme obtenu. Tant que \a pending est vrai, la
+ * compilation est lancée mais pas encore vérifiée : \a vId et \a fId
+ * sont les shaders en cours et \a path le fichier de cache à écrire. */
+typedef struct vhVariant_t vhVariant_t;
+struct vhVariant_t {
+  char * vs, * fs, * defines;
+  GLuint pId, vId, fId;
+  int pending;
+  char path[32];
+};
+
+/*!\brief variantes déjà compilées, leur nombre et la taille allouée */
+static vhVariant_t * _variants = NULL;
+static int _nbVariants = 0, _size = 0;
+/*!\brief buffer du bloc "frame" */
+static GLuint _frameBuffer = 0;
+
+/*!\brief renvoie le contenu du fichier \a name (à libérer), NULL en
+ * cas d'erreur. */
+static char * readFile(const char * name) {
+  FILE * f = fopen(name, "rb");
+  char * s;
+  long n;
+  if(!f) {
+    fprintf(stderr, "can't open file %s\n", name);
+    return NULL;
+  }
+  fseek(f, 0, SEEK_END);
+  n = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  s = malloc(n + 1);
+  assert(s);
+  n = fread(s, 1, n, f);
+  s[n] = '\0';
+  fclose(f);
+  return s;
+}
+
+/*!\brief lance la compilation du shader \a type de source \a src en
+ * insérant \a defines juste après la ligne #version. Le résultat est
+ * vérifié plus tard (voir finish), ce qui laisse le pilote compiler en
+ * parallèle s'il le sait.
+ * \return l'identifiant du shader.
+ */
+static GLuint compile(GLenum type, const char * src, const char * defines) {
+  const GLchar * srcs[4];
+  GLint lens[4] = { 0, -1, -1, -1 };
+  const char * body = src;
+  GLuint sId;
+  if(!strncmp(src, "#version", 8)) {
+    body = strchr(src, '\n');
+    body = body ? body + 1 : src + strlen(src);
+  }
+  srcs[0] = src; lens[0] = body - src;
+  srcs[1] = defines;
+  /* les numéros de ligne des erreurs restent ceux du fichier */
+  srcs[2] = body == src ? "#line 1\n" : "#line 2\n";
+  srcs[3] = body;
+  sId = glCreateShader(type);
+  glShaderSource(sId, 4, srcs, lens);
+  glCompileShader(sId);
+  return sId;
+}
+
+/*!\brief affiche le journal du shader \a sId du fichier \a name
+ * s'il n'a pas compilé.
+ * \return 1 si le shader a compilé.
+ */
+static int compiled(GLuint sId, const char * name, const char * defines) {
+  char log[1024];
+  GLint status;
+  glGetShaderiv(sId, GL_COMPILE_STATUS, &status);
+  if(!status) {
+    glGetShaderInfoLog(sId, sizeof log, NULL, log);
+    fprintf(stderr, "%s (%s) : %s\n", name, defines, log);
+  }
+  return status;
+}
+
+/*!\brief ajoute la chaîne \a s (avec son zéro final) au hachage FNV-1a
+ * \a h. */
+static unsigned long long hash(unsigned long long h, const char * s) {
+  do {
+    h ^= (unsigned char)*s;
+    h *= 0x100000001b3ULL;
+  } while(*s++);
+  return h;
+}
+
+/*!\brief écrit dans \a path le nom du fichier de cache d'un programme
+ * fait des sources \a vsSrc et \a fsSrc et des définitions \a
+ * defines. La clé tient aussi compte du pilote : un autre pilote, ou
+ * une autre version, ne relit pas les binaires de celui-ci. */
+static void cachePath(char * path, size_t size, const char * vsSrc, const char * fsSrc, const char * defines) {
+  const char * gl[3];
+  unsigned long long h = 0xcbf29ce484222325ULL;
+  int i;
+  gl[0] = (const char *)glGetString(GL_VENDOR);
+  gl[1] = (const char *)glGetString(GL_RENDERER);
+  gl[2] = (const char *)glGetString(GL_VERSION);
+  h = hash(h, vsSrc);
+  h = hash(h, fsSrc);
+  h = hash(h, defines);
+  for(i = 0; i < 3; i++)
+    h = hash(h, gl[i] ? gl[i] : "");
+  snprintf(path, size, VH_CACHE_DIR "/%016llx.bin", h);
+}
+
+/*!\brief vaut 1 si le pilote sait relire ses programmes liés. */
+static int hasProgramBinary(void) {
+  GLint n = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &n);
+  return n > 0;
+}
+
+/*!\brief vaut 1 si le pilote compile en tâche de fond et permet de
+ * savoir, sans attendre, si un programme est prêt. */
+static int hasParallelCompile(void) {
+  static int has = -1;
+  GLint i, n = 0;
+  const char * e;
+  if(has >= 0)
+    return has;
+  has = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &n);
+  for(i = 0; i < n && !has; i++) {
+    e = (const char *)glGetStringi(GL_EXTENSIONS, i);
+    has = !strcmp(e, "GL_KHR_parallel_shader_compile") || !strcmp(e, "GL_ARB_parallel_shader_compile");
+  }
+  return has;
+}
+
+/*!\brief recrée un programme à partir du binaire rangé dans \a path.
+ * \return l'identifiant du programme, 0 si le fichier manque ou si le
+ * pilote le refuse (il faut alors recompiler).
+ */
+static GLuint loadBinary(const char * path) {
+  FILE * f = fopen(path, "rb");
+  GLint head[2], status = 0;
+  GLuint pId = 0;
+  void * data;
+  if(!f)
+    return 0;
+  if(fread(head, sizeof head, 1, f) == 1 && head[1] > 0) {
+    data = malloc(head[1]);
+    assert(data);
+    if(fread(data, head[1], 1, f) == 1) {
+      pId = glCreateProgram();
+      glProgramBinary(pId, (GLenum)head[0], data, head[1]);
+      glGetProgramiv(pId, GL_LINK_STATUS, &status);
+      if(!status) {
+        glDeleteProgram(pId);
+        pId = 0;
+      }
+    }
+    free(data);
+  }
+  fclose(f);
+  return pId;
+}
+
+/*!\brief range dans \a path le binaire du programme \a pId. Un échec
+ * (dossier en lecture seule, ...) n'empêche rien, le programme sera
+ * simplement recompilé au prochain lancement. */
+static void saveBinary(GLuint pId, const char * path) {
+  GLint head[2] = { 0, 0 };
+  GLenum format;
+  FILE * f;
+  void * data;
+  glGetProgramiv(pId, GL_PROGRAM_BINARY_LENGTH, &head[1]);
+  if(head[1] <= 0)
+    return;
+  data = malloc(head[1]);
+  assert(data);
+  glGetProgramBinary(pId, head[1], NULL, &format, data);
+  head[0] = (GLint)format;
+  mkdir(VH_CACHE_DIR, 0755);
+  if((f = fopen(path, "wb")) != NULL) {
+    fwrite(head, sizeof head, 1, f);
+    fwrite(data, head[1], 1, f);
+    fclose(f);
+  }
+  free(data);
+}
+
+/*!\brief relie le bloc "frame" de \a pId, s'il en a un, au buffer
+ * de vhFrame. */
+static void bindFrame(GLuint pId) {
+  GLuint block = glGetUniformBlockIndex(pId, "frame");
+  if(block != GL_INVALID_INDEX)
+    glUniformBlockBinding(pId, block, VH_FRAME_BINDING);
+}
+
+/*!\brief renvoie la variante (\a vs, \a fs, \a defines), NULL si
+ * elle n'a pas encore été demandée. */
+static vhVariant_t * find(const char * vs, const char * fs, const char * defines) {
+  int i;
+  vhVariant_t * v;
+  for(i = 0; i < _nbVariants; i++) {
+    v = &_variants[i];
+    if(!strcmp(v->vs, vs) && !strcmp(v->fs, fs) && !strcmp(v->defines, defines))
+      return v;
+  }
+  return NULL;
+}
+
+/*!\brief ajoute la variante (\a vs, \a fs, \a defines) et lance sa
+ * construction : relecture du binaire en cache si possible, sinon
+ * compilation et édition de liens, vérifiées plus tard par finish. */
+static vhVariant_t * start(const char * vs, const char * fs, const char * defines) {
+  char * vsSrc = readFile(vs), * fsSrc = readFile(fs);
+  int binary = hasProgramBinary();
+  vhVariant_t * v;
+  if(_nbVariants == _size) {
+    _size = _size ? 2 * _size : 16;
+    _variants = realloc(_variants, _size * sizeof *_variants);
+    assert(_variants);
+  }
+  v = &_variants[_nbVariants++];
+  memset(v, 0, sizeof *v);
+  v->vs = strdup(vs);
+  v->fs = strdup(fs);
+  v->defines = strdup(defines);
+  if(vsSrc && fsSrc) {
+    if(binary) {
+      cachePath(v->path, sizeof v->path, vsSrc, fsSrc, defines);
+      if((v->pId = loadBinary(v->path)) != 0)
+        bindFrame(v->pId);
+    }
+    if(!v->pId) {
+      v->vId = compile(GL_VERTEX_SHADER, vsSrc, defines);
+      v->fId = compile(GL_FRAGMENT_SHADER, fsSrc, defines);
+      v->pId = glCreateProgram();
+      glAttachShader(v->pId, v->vId);
+      glAttachShader(v->pId, v->fId);
+      if(binary)
+        glProgramParameteri(v->pId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+      glLinkProgram(v->pId);
+      v->pending = 1;
+    }
+  }
+  free(vsSrc);
+  free(fsSrc);
+  return v;
+}
+
+/*!\brief termine la construction de \a v (attend le pilote si besoin) :
+ * vérifie la compilation et l'édition de liens, puis range le binaire
+ * dans le cache.
+ * \return l'identifiant du programme, 0 en cas d'échec.
+ */
+static GLuint finish(vhVariant_t * v) {
+  GLint status;
+  char log[1024];
+  if(!v->pending)
+    return v->pId;
+  v->pending = 0;
+  glGetProgramiv(v->pId, GL_LINK_STATUS, &status);
+  if(!status) {
+    if(compiled(v->vId, v->vs, v->defines) && compiled(v->fId, v->fs, v->defines)) {
+      glGetProgramInfoLog(v->pId, sizeof log, NULL, log);
+      fprintf(stderr, "%s, %s (%s) : %s\n", v->vs, v->fs, v->defines, log);
+    }
+  }
+  glDetachShader(v->pId, v->vId);
+  glDetachShader(v->pId, v->fId);
+  glDeleteShader(v->vId);
+  glDeleteShader(v->fId);
+  v->vId = v->fId = 0;
+  if(!status) {
+    glDeleteProgram(v->pId);
+    v->pId = 0;
+    return 0;
+  }
+  bindFrame(v->pId);
+  if(v->path[0])
+    saveBinary(v->pId, v->path);
+  return v->pId;
+}
+
+/*!\brief renvoie le programme construit avec les shaders des fichiers
+ * \a vs et \a fs, chacun précédé des définitions \a defines (par
+ * exemple "#define WAVE\n"). Chaque variante n'est construite qu'une
+ * fois ; les appels suivants la retrouvent dans le cache. Le binaire
+ * lié est aussi rangé sur disque, sous une clé tirée des sources, des
+ * définitions et du pilote, et relu aux lancements suivants ; s'il est
+ * absent ou refusé, le programme est compilé normalement.
+ * \return l'identifiant du programme, 0 en cas d'échec.
+ */
+GLuint vhProgram(const char * vs, const char * fs, const char * defines) {
+  vhVariant_t * v;
+  if(!defines)
+    defines = "";
+  if(!(v = find(vs, fs, defines)))
+    v = start(vs, fs, defines);
+  return finish(v);
+}
+
+/*!\brief lance, sans l'attendre, la construction de la variante (\a
+ * vs, \a fs, \a defines) ; vhProgram la trouvera prête. Sert à tout
+ * compiler pendant un chargement (voir vhPending).
+ * \return 1 si une compilation a été lancée, 0 si la variante était
+ * déjà connue ou relue depuis le cache.
+ */
+int vhPrepare(const char * vs, const char * fs, const char * defines) {
+  if(!defines)
+    defines = "";
+  if(find(vs, fs, defines))
+    return 0;
+  return start(vs, fs, defines)->pending;
+}
+
+/*!\brief avance les constructions lancées par vhPrepare. Si le pilote
+ * compile en parallèle, termine celles qui sont prêtes sans attendre ;
+ * sinon en termine une seule, pour que l'appelant puisse afficher sa
+ * progression entre deux appels.
+ * \return le nombre de variantes encore en cours.
+ */
+int vhPending(void) {
+  int i, n = 0, parallel = hasParallelCompile(), waited = 0;
+  GLint done;
+  for(i = 0; i < _nbVariants; i++) {
+    vhVariant_t * v = &_variants[i];
+    if(!v->pending)
+      continue;
+    if(parallel)
+      glGetProgramiv(v->pId, GL_COMPLETION_STATUS_KHR, &done);
+    else
+      done = !waited++;
+    if(done)
+      finish(v);
+    else
+      n++;
+  }
+  return n;
+}
+
+/*!\brief relève dans \a loc les emplacements des \a n uniforms \a
+ * names de \a pId (-1 pour ceux qu'il n'utilise pas). À faire une fois,
+ * le programme obtenu, pour que le dessin n'utilise que ces
+ * emplacements. */
+void vhUniforms(GLuint pId, const char * const * names, int n, GLint * loc) {
+  int i;
+  for(i = 0; i < n; i++)
+    loc[i] = glGetUniformLocation(pId, names[i]);
+}
+
+/*!\brief envoie les valeurs communes de la frame \a f au bloc std140
+ * "frame", partagé par tous les programmes qui le déclarent :
+ *
+ * layout (std140) uniform frame {
+ *   vec4  frResolution;
+ *   float frTime, frBasses, frAigus;
+ * };
+ *
+ * À appeler une fois par frame, avant de dessiner. */
+void vhFrame(const vhFrame_t * f) {
+  if(!_frameBuffer) {
+    glGenBuffers(1, &_frameBuffer);
+    glBindBufferBase(GL_UNIFORM_BUFFER, VH_FRAME_BINDING, _frameBuffer);
+  }
+  glBindBuffer(GL_UNIFORM_BUFFER, _frameBuffer);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof *f, f, GL_STREAM_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/*!\brief libère toutes les variantes. */
+void vhClean(void) {
+  int i;
+  for(i = 0; i < _nbVariants; i++) {
+    finish(&_variants[i]);
+    glDeleteProgram(_variants[i].pId);
+    free(_variants[i].vs);
+    free(_variants[i].fs);
+    free(_variants[i].defines);
+  }
+  free(_variants);
+  _variants = NULL;
+  _nbVariants = _size = 0;
+  if(_frameBuffer) {
+    glDeleteBuffers(1, &_frameBuffer);
+    _frameBuffer = 0;
+  }
+}
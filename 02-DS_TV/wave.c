@@ -6,6 +6,8 @@
 #include <fftw3.h>
 #include <GL4D/gl4dh.h>
 #include "audioHelper.h"
+#include "variantHelper.h"
+#include "stateHelper.h"
 
 static void init(int w, int h);
 static void draw(void);
@@ -15,8 +17,12 @@ static void quit(void);
 static GLuint _screen = 0;
 /* !\brief dimensions de la démo */
 static int _w, _h;
-/*!\brief identifiant du programme GLSL */
-static GLuint _pId = 0;
+/*!\brief variantes du programme GLSL : cercle puis ondes (WAVE) */
+static GLuint _pId[2] = {0};
+/*!\brief emplacements des uniforms de chaque variante */
+enum { U_TIME = 0, U_BASSES, U_LINE, U_NB };
+static const char * const _uNames[U_NB] = { "time", "basses", "line" };
+static GLint _u[2][U_NB];
 /*!\brief identifiant du cube de GL4Dummies */
 static GLuint _quad = 0;
 /* !\brief basses de la démo */
@@ -31,7 +37,10 @@ static void init(int w, int h) {
   _w = w;
   _h = h;
   glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-  _pId = gl4duCreateProgram("<vs>shaders/wave.vs", "<fs>shaders/wave.fs", NULL);
+  _pId[0] = vhProgram("shaders/wave.vs", "shaders/wave.fs", NULL);
+  _pId[1] = vhProgram("shaders/wave.vs", "shaders/wave.fs", "#define WAVE\n");
+  vhUniforms(_pId[0], _uNames, U_NB, _u[0]);
+  vhUniforms(_pId[1], _uNames, U_NB, _u[1]);
   _quad = gl4dgGenQuadf();
   glBindTexture(GL_TEXTURE_1D, 0);
 }
@@ -41,19 +50,19 @@ static void draw(void) {
   static int prev_basses = 0;
   static float line = 10.0;
   int time = SDL_GetTicks();
-  glDisable(GL_DEPTH_TEST);
-  glUseProgram(_pId);
+  GLuint pId = _pId[_wave];
+  shDisable(GL_DEPTH_TEST);
+  shUseProgram(pId);
 
   glClear(GL_COLOR_BUFFER_BIT);  
-  glUniform1i(glGetUniformLocation(_pId, "time"), time);
-  glUniform1i(glGetUniformLocation(_pId, "basses"), _basses);
-  glUniform1i(glGetUniformLocation(_pId, "wave"), _wave);
-  glUniform1f(glGetUniformLocation(_pId, "line"), line);
+  glUniform1i(_u[_wave][U_TIME], time);
+  glUniform1i(_u[_wave][U_BASSES], _basses);
+  glUniform1f(_u[_wave][U_LINE], line);
   gl4dgDraw(_quad);
   
   glBindVertexArray(0);
   glBindTexture(GL_TEXTURE_1D, 0);
-  glUseProgram(0);
+  shUseProgram(0);
 
   /* nombre de lignes pour la représentation du cercle */
   if (prev_basses >= 15 && _basses >= 15) { 
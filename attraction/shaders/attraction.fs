@@ -1,18 +1,17 @@
 #version 330
-uniform sampler1D mobiles;
-uniform float step;
+uniform samplerBuffer mobiles;
+uniform int nbMobiles;
 uniform int time;
 uniform float onde;
 in  vec2 vsoTexCoord;
 out vec4 fragColor;
 
 vec4 balle(void) {
-  float i;
-  for(i = step / 2.0; i < 1.0; i += 2.0 * step) {
-    vec3 po = texture(mobiles, i + step).xyz;
+  for(int i = 0; i < nbMobiles; i++) {
+    vec3 po = texelFetch(mobiles, 2 * i + 1).xyz;
     float d = length(vsoTexCoord - po.xy) - po.z;
     if(d < 0)
-      return texture(mobiles, i);
+      return texelFetch(mobiles, 2 * i);
   }
   return vec4(1);
 }
@@ -0,0 +1,22 @@
+#ifndef _UPLOAD_HELPER_H
+
+#define _UPLOAD_HELPER_H
+
+#include <GL4D/gl4du.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  typedef struct uhRing_t uhRing_t;
+
+  extern uhRing_t * uhNew(GLsizeiptr size, GLenum format);
+  extern void *     uhMap(uhRing_t * r);
+  extern GLuint     uhCommit(uhRing_t * r);
+  extern void       uhDelete(uhRing_t * r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
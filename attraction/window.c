@@ -1,4 +1,5 @@
 #include "mobile.h"
+#include "uploadHelper.h"
 
 static void init(void);
 static void resize(int w, int h);
@@ -10,8 +11,9 @@ static void quit(void);
 static int _windowWidth = 600, _windowHeight = 600;
 /*!\brief GLSL program Id */
 static GLuint _pId = 0;
-/*!\brief mobiles' texture Id for storing mobile coordinates */
-static GLuint _tId = 0;
+/*!\brief upload ring the mobiles are written to, read by id as a
+ * buffer texture */
+static uhRing_t * _ring = NULL;
 /*!\brief A generated Quad Id */
 static GLuint _quad = 0;
 /*!\brief number of mobiles to simulate */
@@ -44,14 +46,8 @@ static void init(void) {
   resize(_windowWidth, _windowHeight);
   /* generating a Quad (Vertex coords + Vertex Normal + Vertex TexCoord */
   _quad = gl4dgGenQuadf();
-  /* creating a 1D texture to store mobile coords */
-  glGenTextures(1, &_tId);
-  glBindTexture(GL_TEXTURE_1D, _tId);
-  glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA32F, 1, 0, GL_RGBA, GL_FLOAT, NULL);
-  glBindTexture(GL_TEXTURE_1D, 0);
+  /* creating the ring of buffers storing mobile colors and coords */
+  _ring = uhNew(_nbMobiles * 8 * sizeof(GLfloat), GL_RGBA32F);
   /* calling mobileInit */
   mobileInit(_nbMobiles, _windowWidth, _windowHeight);
 }
@@ -81,27 +77,24 @@ static void keydown(int keycode) {
 static void draw(void) {
   static GLfloat onde = 3.0;
   int time = SDL_GetTicks();
-  GLfloat * f = malloc(_nbMobiles * 8 * sizeof *f), step = 1.0 / (_nbMobiles * 2);
-  assert(f);
   glDisable(GL_DEPTH_TEST);
   glUseProgram(_pId);
 
   glClear(GL_COLOR_BUFFER_BIT);  
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_1D, _tId);
   mobileMove();
-  mobile2texture(f);
-  glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA32F, 2 * _nbMobiles, 0, GL_RGBA, GL_FLOAT, f);
-  free(f);
+  /* the simulation writes straight into the mapped buffer */
+  mobile2texture(uhMap(_ring));
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_BUFFER, uhCommit(_ring));
   glUniform1i(glGetUniformLocation(_pId, "mobiles"), 0);
+  glUniform1i(glGetUniformLocation(_pId, "nbMobiles"), _nbMobiles);
   glUniform1i(glGetUniformLocation(_pId, "time"), time);
-  glUniform1f(glGetUniformLocation(_pId, "step"), step);
   glUniform1f(glGetUniformLocation(_pId, "onde"), onde);
 
   gl4dgDraw(_quad);
   glBindVertexArray(0);
-  glBindTexture(GL_TEXTURE_1D, 0);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
   glUseProgram(0);
   onde -= 0.01;
   if(onde < 0) onde = 3.0;
@@ -109,7 +102,10 @@ static void draw(void) {
 
 /*!\brief called at exit and delete and clean used data. */
 static void quit(void) {
-  if(_tId) 
-    glDeleteTextures(1, &_tId);
+  if(_ring) {
+    uhDelete(_ring);
+    _ring = NULL;
+  }
+  mobileClean();
   gl4duClean(GL4DU_ALL);
 }
@@ -57,6 +57,8 @@ enum bones_e {
 static int _wW = 1024, _wH = 768;
 /*!\brief identifiant du GLSL program */
 static GLuint _pId = 0;
+/*!\brief emplacement de l'uniform "color" de _pId, relevé une fois */
+static GLint _uColor = -1;
 /*!\brief identifiant de figures géométriques de GL4Dummies */
 static GLuint _cylinder = 0, _sphere = 0, _cube = 0;
 /*!\brief ensemble des gestuelles */
@@ -143,6 +145,7 @@ void lmListener::onFrame(const Controller& controller) {
 static void init(void) {
   glClearColor(_color[0], _color[1], _color[2], 0.0f);
   _pId  = gl4duCreateProgram("<vs>shaders/basic.vs", "<fs>shaders/basic.fs", NULL);
+  _uColor = glGetUniformLocation(_pId, "color");
   gl4duGenMatrix(GL_FLOAT, "modelViewMatrix");
   gl4duGenMatrix(GL_FLOAT, "projectionMatrix");
   resize(_wW, _wH);
@@ -333,7 +336,7 @@ static void drawOptions(void) {
       -12.0);
     gl4duScalef(0.25, 0.25, 0.25);
     gl4duSendMatrices();
-    glUniform4fv(glGetUniformLocation(_pId, "color"), 1, green);
+    glUniform4fv(_uColor, 1, green);
     gl4dgDraw(_sphere);
   } gl4duPopMatrix();
 
@@ -344,7 +347,7 @@ static void drawOptions(void) {
       -12.0);
     gl4duScalef(0.25, 0.25, 0.25);
     gl4duSendMatrices();
-    glUniform4fv(glGetUniformLocation(_pId, "color"), 1, yellow);
+    glUniform4fv(_uColor, 1, yellow);
     gl4dgDraw(_sphere);
   } gl4duPopMatrix();
 
@@ -355,7 +358,7 @@ static void drawOptions(void) {
       -12.0);
     gl4duScalef(0.25, 0.25, 0.25);
     gl4duSendMatrices();
-    glUniform4fv(glGetUniformLocation(_pId, "color"), 1, cyan);
+    glUniform4fv(_uColor, 1, cyan);
     gl4dgDraw(_sphere);
   } gl4duPopMatrix();
 }
@@ -388,7 +391,7 @@ static void drawMobile(void) {
           indexPos[1] * 0.02 - 3.0f,
           -10.0);
         gl4duSendMatrices();
-        glUniform4fv(glGetUniformLocation(_pId, "color"), 1, red);
+        glUniform4fv(_uColor, 1, red);
         gl4dgDraw(_sphere);
       } gl4duPopMatrix();
     }
@@ -417,7 +420,7 @@ static void drawHand(void) {
             -10.0);
           gl4duScalef(0.1, 0.1, 0.1);
           gl4duSendMatrices();
-          glUniform4fv(glGetUniformLocation(_pId, "color"), 1, white);
+          glUniform4fv(_uColor, 1, white);
           gl4dgDraw(_sphere);
         } gl4duPopMatrix();
       }
@@ -469,7 +472,7 @@ static void drawHandSkeleton(void) {
             boneScale * fingerRad * 0.02,
             boneScale * fingerRad * 0.02);
             gl4duSendMatrices();
-            glUniform4fv(glGetUniformLocation(_pId, "color"), 1, white);
+            glUniform4fv(_uColor, 1, white);
             gl4dgDraw(_cylinder);
           } gl4duPopMatrix();
 
@@ -483,7 +486,7 @@ static void drawHandSkeleton(void) {
               jointScale * fingerRad * 0.02, 
               jointScale * fingerRad * 0.02);
             gl4duSendMatrices();
-            glUniform4fv(glGetUniformLocation(_pId, "color"), 1, white);
+            glUniform4fv(_uColor, 1, white);
             gl4dgDraw(_sphere);
           } gl4duPopMatrix();
         }
@@ -500,7 +503,7 @@ static void drawHandSkeleton(void) {
           boneScale * fingerRad * 0.02,
           boneScale * fingerRad * 0.02);
         gl4duSendMatrices();
-        glUniform4fv(glGetUniformLocation(_pId, "color"), 1, white);
+        glUniform4fv(_uColor, 1, white);
         gl4dgDraw(_cylinder);
       } gl4duPopMatrix();
 
@@ -514,7 +517,7 @@ static void drawHandSkeleton(void) {
           jointScale * fingerRad * 0.02,
           jointScale * fingerRad * 0.02);
         gl4duSendMatrices();
-        glUniform4fv(glGetUniformLocation(_pId, "color"), 1, white);
+        glUniform4fv(_uColor, 1, white);
         gl4dgDraw(_sphere);
       } gl4duPopMatrix();
       vLastBoxBase = vCurBoxBase;
@@ -533,7 +536,7 @@ static void drawHandSkeleton(void) {
         boneScale * fingerRad * 0.02, 
         boneScale * fingerRad * 0.02);
       gl4duSendMatrices();
-      glUniform4fv(glGetUniformLocation(_pId, "color"), 1, white);
+      glUniform4fv(_uColor, 1, white);
       gl4dgDraw(_cylinder);
     } gl4duPopMatrix();
 
@@ -547,7 +550,7 @@ static void drawHandSkeleton(void) {
         jointScale * fingerRad * 0.02,
         jointScale * fingerRad * 0.02);
       gl4duSendMatrices();
-      glUniform4fv(glGetUniformLocation(_pId, "color"), 1, white);
+      glUniform4fv(_uColor, 1, white);
       gl4dgDraw(_sphere);
     } gl4duPopMatrix();
 
@@ -562,7 +565,7 @@ static void drawHandSkeleton(void) {
         palmScale * fingerRad * 0.02,
         palmScale * fingerRad * 0.02);
       gl4duSendMatrices();
-      glUniform4fv(glGetUniformLocation(_pId, "color"), 1, white);
+      glUniform4fv(_uColor, 1, white);
       gl4dgDraw(_sphere);
     } gl4duPopMatrix();
   }
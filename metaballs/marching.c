@@ -0,0 +1,368 @@
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <SDL.h>
+#include "marching.h"
+
+#ifndef MAX
+#  define MAX(a, b) ((a) > (b) ? (a) : (b))
+#  define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+
+/*!\brief cells per block side, the field is only sampled in blocks
+ * reached by at least one ball */
+#define MC_BLOCK 8
+/*!\brief samples per block side */
+#define MC_SAMPLES (MC_BLOCK + 1)
+/*!\brief maximum number of triangles for one cube case */
+#define MC_MAX_TRIS 12
+
+/*!\brief per thread data: field and gradient samples of the current
+ * block and the reusable vertex arena (position then normal, 6 floats
+ * per vertex) */
+typedef struct mcThread_t mcThread_t;
+struct mcThread_t {
+  SDL_Thread * thread;
+  float field[4 * MC_SAMPLES * MC_SAMPLES * MC_SAMPLES];
+  float * v;
+  int nv, size;
+};
+
+/*!\brief cube corners (bit 0: x, bit 1: y, bit 2: z), edges and
+ * triangle table (edge ids, -1 terminated), built by mcInit */
+static int _edges[12][2];
+static int _triTable[256][3 * MC_MAX_TRIS + 1];
+
+/*!\brief grid resolution (cells per side), blocks per side, box
+ * origin, cell size and its inverse */
+static int _res = 0, _nb = 0;
+static float _lo[3], _cell[3], _icell[3];
+/*!\brief current balls (x, y, z, support radius), count and iso value */
+static const float * _balls = NULL;
+static int _n = 0;
+static float _iso = 0.5f;
+/*!\brief balls binned per block : ids of block b are in
+ * _blockList[_blockStart[b] .. _blockStart[b + 1][ */
+static int * _blockStart = NULL, * _blockList = NULL, _listSize = 0;
+
+/*!\brief thread pool: workers wait for a new frame number, take rows
+ * of blocks from an atomic counter and report when done */
+static mcThread_t * _threads = NULL;
+static int _nbThreads = 0, _frame = 0, _finished = 0, _quit = 0;
+static SDL_mutex * _mutex = NULL;
+static SDL_cond * _start = NULL, * _done = NULL;
+static SDL_atomic_t _nextRow;
+
+/*!\brief floor and ceiling to int; floorf and ceilf are library
+ * calls on baseline x86-64 and sit in the inner loops */
+static inline int ifloor(float v) {
+  int i = (int)v;
+  return i - (v < i);
+}
+
+static inline int iceil(float v) {
+  int i = (int)v;
+  return i + (v > i);
+}
+
+/*!\brief builds the triangle table from the cube faces. On each face,
+ * every run of inside corners (walking the face counterclockwise seen
+ * from outside) gives a segment from the edge where the walk enters
+ * the run to the edge where it leaves it. An edge is entered on one
+ * of its two faces and left on the other, so the segments chain into
+ * closed loops that are then fanned into triangles. Ambiguous faces
+ * always separate inside corners; the rule only depends on the face,
+ * so neighbouring cubes agree and the surface has no cracks. */
+static void buildTables(void) {
+  static const int faces[6][4] = {
+    { 0, 4, 6, 2 }, { 1, 3, 7, 5 }, /* x = 0, x = 1 */
+    { 0, 1, 5, 4 }, { 2, 6, 7, 3 }, /* y = 0, y = 1 */
+    { 0, 2, 3, 1 }, { 4, 5, 7, 6 }  /* z = 0, z = 1 */
+  };
+  int edgeOf[8][8], c, a, b, e = 0, f, k, m;
+  for(a = 0; a < 8; a++)
+    for(b = a + 1; b < 8; b++)
+      if(((a ^ b) & ((a ^ b) - 1)) == 0) {
+        _edges[e][0] = a; _edges[e][1] = b;
+        edgeOf[a][b] = edgeOf[b][a] = e++;
+      }
+  for(c = 0; c < 256; c++) {
+    int next[12], seen[12] = { 0 }, nt = 0;
+    for(k = 0; k < 12; k++) next[k] = -1;
+    for(f = 0; f < 6; f++) {
+      for(k = 0; k < 4; k++) {
+        int v0 = faces[f][k], v1 = faces[f][(k + 1) & 3];
+        if((c >> v0 & 1) || !(c >> v1 & 1))
+          continue;
+        /* entering a run of inside corners, look for its end */
+        for(m = 1; m < 4; m++) {
+          int w0 = faces[f][(k + m) & 3], w1 = faces[f][(k + m + 1) & 3];
+          if((c >> w0 & 1) && !(c >> w1 & 1)) {
+            next[edgeOf[v0][v1]] = edgeOf[w0][w1];
+            break;
+          }
+        }
+      }
+    }
+    for(k = 0; k < 12; k++) {
+      int loop[12], l = 0, j;
+      if(next[k] < 0 || seen[k]) continue;
+      for(j = k; !seen[j]; j = next[j]) {
+        seen[j] = 1;
+        loop[l++] = j;
+      }
+      for(j = 1; j + 1 < l; j++) {
+        assert(nt < MC_MAX_TRIS);
+        _triTable[c][3 * nt + 0] = loop[0];
+        _triTable[c][3 * nt + 1] = loop[j];
+        _triTable[c][3 * nt + 2] = loop[j + 1];
+        nt++;
+      }
+    }
+    _triTable[c][3 * nt] = -1;
+  }
+}
+
+/*!\brief appends to the arena of \a t the vertex interpolated on the
+ * edge between samples \a f0 and \a f1 (field then gradient) at
+ * grid coordinates \a g0 and \a g1. The normal is minus the
+ * interpolated gradient. */
+static void emit(mcThread_t * t, const float * f0, const float * f1, const int * g0, const int * g1) {
+  int a;
+  float s = (_iso - f0[0]) / (f1[0] - f0[0]), n[3], l, * v;
+  for(a = 0; a < 3; a++)
+    n[a] = f0[a + 1] + s * (f1[a + 1] - f0[a + 1]);
+  l = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+  l = l > 0.0f ? -1.0f / l : 0.0f;
+  if(t->nv == t->size) {
+    t->size = t->size ? 2 * t->size : 4096;
+    t->v = realloc(t->v, t->size * 6 * sizeof *t->v);
+    assert(t->v);
+  }
+  v = &t->v[6 * t->nv++];
+  for(a = 0; a < 3; a++) {
+    v[a] = _lo[a] + (g0[a] + s * (g1[a] - g0[a])) * _cell[a];
+    v[a + 3] = l * n[a];
+  }
+}
+
+/*!\brief samples the field and its gradient on block (\a bx, \a by,
+ * \a bz) then polygonises its cells. Each ball only visits the
+ * samples inside its support, so the cost follows the local
+ * density. Samples are placed from their global grid index so that
+ * neighbouring blocks compute the same values on shared faces; the
+ * outer layer of the grid stays at zero to close the surface on the
+ * box walls. */
+static void block(mcThread_t * t, int bx, int by, int bz) {
+  int b = (bz * _nb + by) * _nb + bx, i, x, y, z, lo[3], hi[3], a;
+  int o[3] = { bx * MC_BLOCK, by * MC_BLOCK, bz * MC_BLOCK };
+  float * f = t->field;
+  if(_blockStart[b] == _blockStart[b + 1])
+    return;
+  memset(f, 0, sizeof t->field);
+  for(i = _blockStart[b]; i < _blockStart[b + 1]; i++) {
+    const float * s = &_balls[4 * _blockList[i]];
+    float ir2 = 1.0f / (s[3] * s[3]);
+    for(a = 0; a < 3; a++) {
+      lo[a] = MAX(MAX(iceil((s[a] - s[3] - _lo[a]) * _icell[a]), 1) - o[a], 0);
+      hi[a] = MIN(MIN(ifloor((s[a] + s[3] - _lo[a]) * _icell[a]), _res - 1) - o[a], MC_BLOCK);
+    }
+    for(z = lo[2]; z <= hi[2]; z++) {
+      float dz = _lo[2] + (o[2] + z) * _cell[2] - s[2];
+      for(y = lo[1]; y <= hi[1]; y++) {
+        float dy = _lo[1] + (o[1] + y) * _cell[1] - s[1], dyz = dy * dy + dz * dz, w;
+        float * row = &f[4 * (z * MC_SAMPLES + y) * MC_SAMPLES];
+        int x0, x1;
+        if(dyz >= s[3] * s[3]) continue;
+        /* chord of the support on this row */
+        w = sqrtf(s[3] * s[3] - dyz);
+        x0 = MAX(iceil((s[0] - w - _lo[0]) * _icell[0]) - o[0], lo[0]);
+        x1 = MIN(ifloor((s[0] + w - _lo[0]) * _icell[0]) - o[0], hi[0]);
+        for(x = x0; x <= x1; x++) {
+          float dx = _lo[0] + (o[0] + x) * _cell[0] - s[0], q = MAX(1.0f - (dx * dx + dyz) * ir2, 0.0f);
+          /* d(q^3) = -6 q^2 d / R^2 */
+          float g = -6.0f * q * q * ir2;
+          row[4 * x + 0] += q * q * q;
+          row[4 * x + 1] += g * dx;
+          row[4 * x + 2] += g * dy;
+          row[4 * x + 3] += g * dz;
+        }
+      }
+    }
+  }
+  for(z = 0; z < MC_BLOCK; z++)
+    for(y = 0; y < MC_BLOCK; y++)
+      for(x = 0; x < MC_BLOCK; x++) {
+        const float * v[8];
+        int c = 0, k;
+        const int * tri;
+        for(k = 0; k < 8; k++) {
+          v[k] = &f[4 * (((z + (k >> 2)) * MC_SAMPLES + y + (k >> 1 & 1)) * MC_SAMPLES + x + (k & 1))];
+          c |= (v[k][0] > _iso) << k;
+        }
+        if(c == 0 || c == 255) continue;
+        for(tri = _triTable[c]; *tri >= 0; tri++) {
+          int c0 = _edges[*tri][0], c1 = _edges[*tri][1];
+          int g0[3] = { o[0] + x + (c0 & 1), o[1] + y + (c0 >> 1 & 1), o[2] + z + (c0 >> 2) };
+          int g1[3] = { o[0] + x + (c1 & 1), o[1] + y + (c1 >> 1 & 1), o[2] + z + (c1 >> 2) };
+          emit(t, v[c0], v[c1], g0, g1);
+        }
+      }
+}
+
+/*!\brief worker thread: polygonises rows of blocks until none is left
+ * for the current frame. */
+static int worker(void * data) {
+  mcThread_t * t = data;
+  int frame = 0, row;
+  for(;;) {
+    SDL_LockMutex(_mutex);
+    while(_frame == frame && !_quit)
+      SDL_CondWait(_start, _mutex);
+    frame = _frame;
+    SDL_UnlockMutex(_mutex);
+    if(_quit)
+      return 0;
+    t->nv = 0;
+    while((row = SDL_AtomicAdd(&_nextRow, 1)) < _nb * _nb) {
+      int x;
+      for(x = 0; x < _nb; x++)
+        block(t, x, row % _nb, row / _nb);
+    }
+    SDL_LockMutex(_mutex);
+    if(++_finished == _nbThreads)
+      SDL_CondSignal(_done);
+    SDL_UnlockMutex(_mutex);
+  }
+}
+
+/*!\brief prepares a \a res^3 grid (rounded up to whole blocks) and a
+ * pool of \a nbThreads workers (the CPU count if <= 0). */
+void mcInit(int res, int nbThreads) {
+  int i;
+  mcClean();
+  buildTables();
+  _nb = (res + MC_BLOCK - 1) / MC_BLOCK;
+  _res = _nb * MC_BLOCK;
+  _blockStart = malloc((_nb * _nb * _nb + 1) * sizeof *_blockStart);
+  assert(_blockStart);
+  _nbThreads = nbThreads > 0 ? nbThreads : MAX(SDL_GetCPUCount(), 1);
+  _threads = calloc(_nbThreads, sizeof *_threads);
+  assert(_threads);
+  _mutex = SDL_CreateMutex();
+  _start = SDL_CreateCond();
+  _done = SDL_CreateCond();
+  _frame = _finished = _quit = 0;
+  for(i = 0; i < _nbThreads; i++) {
+    _threads[i].thread = SDL_CreateThread(worker, "marching", &_threads[i]);
+    assert(_threads[i].thread);
+  }
+}
+
+/*!\brief gives the range of blocks reached by the support of ball
+ * \a i, returns 0 if none. */
+static int ballBlocks(int i, int * lo, int * hi) {
+  int a;
+  const float * s = &_balls[4 * i];
+  if(s[3] <= 0.0f) return 0;
+  for(a = 0; a < 3; a++) {
+    lo[a] = MAX(ifloor((s[a] - s[3] - _lo[a]) * _icell[a]) / MC_BLOCK, 0);
+    hi[a] = MIN(ifloor((s[a] + s[3] - _lo[a]) * _icell[a]) / MC_BLOCK, _nb - 1);
+    if(lo[a] > hi[a]) return 0;
+  }
+  return 1;
+}
+
+/*!\brief bins the balls into the blocks (counting sort), empty blocks
+ * are skipped by the workers. */
+static void bin(void) {
+  int i, x, y, z, lo[3], hi[3], nbb = _nb * _nb * _nb;
+  memset(_blockStart, 0, (nbb + 1) * sizeof *_blockStart);
+  for(i = 0; i < _n; i++)
+    if(ballBlocks(i, lo, hi))
+      for(z = lo[2]; z <= hi[2]; z++)
+        for(y = lo[1]; y <= hi[1]; y++)
+          for(x = lo[0]; x <= hi[0]; x++)
+            _blockStart[(z * _nb + y) * _nb + x + 1]++;
+  for(i = 0; i < nbb; i++)
+    _blockStart[i + 1] += _blockStart[i];
+  if(_blockStart[nbb] > _listSize) {
+    _listSize = MAX(_blockStart[nbb], 2 * _listSize);
+    _blockList = realloc(_blockList, _listSize * sizeof *_blockList);
+    assert(_blockList);
+  }
+  /* _blockStart[b] is used as a cursor, then shifted back */
+  for(i = 0; i < _n; i++)
+    if(ballBlocks(i, lo, hi))
+      for(z = lo[2]; z <= hi[2]; z++)
+        for(y = lo[1]; y <= hi[1]; y++)
+          for(x = lo[0]; x <= hi[0]; x++)
+            _blockList[_blockStart[(z * _nb + y) * _nb + x]++] = i;
+  for(i = nbb; i > 0; i--)
+    _blockStart[i] = _blockStart[i - 1];
+  _blockStart[0] = 0;
+}
+
+/*!\brief polygonises the \a iso-surface of the \a n balls (x, y, z,
+ * support radius) over the box [\a lo, \a hi]. Blocks of the grid
+ * are binned on the calling thread then rows of blocks are shared by
+ * the workers, each filling its own arena.
+ * \return the total number of vertices (3 per triangle).
+ */
+int mcPolygonise(const float * balls, int n, const float * lo, const float * hi, float iso) {
+  int a, i, nv = 0;
+  _balls = balls; _n = n; _iso = iso;
+  for(a = 0; a < 3; a++) {
+    _lo[a] = lo[a];
+    _cell[a] = (hi[a] - lo[a]) / _res;
+    _icell[a] = 1.0f / _cell[a];
+  }
+  bin();
+  SDL_AtomicSet(&_nextRow, 0);
+  SDL_LockMutex(_mutex);
+  _finished = 0;
+  _frame++;
+  SDL_CondBroadcast(_start);
+  while(_finished < _nbThreads)
+    SDL_CondWait(_done, _mutex);
+  SDL_UnlockMutex(_mutex);
+  for(i = 0; i < _nbThreads; i++)
+    nv += _threads[i].nv;
+  return nv;
+}
+
+/*!\brief number of vertex arenas (one per worker). */
+int mcArenas(void) {
+  return _nbThreads;
+}
+
+/*!\brief gives arena \a i (6 floats per vertex) and its vertex count
+ * in \a nv. */
+const float * mcArena(int i, int * nv) {
+  *nv = _threads[i].nv;
+  return _threads[i].v;
+}
+
+/*!\brief stops the workers and frees the grid and arenas. */
+void mcClean(void) {
+  int i;
+  if(_threads) {
+    SDL_LockMutex(_mutex);
+    _quit = 1;
+    SDL_CondBroadcast(_start);
+    SDL_UnlockMutex(_mutex);
+    for(i = 0; i < _nbThreads; i++) {
+      SDL_WaitThread(_threads[i].thread, NULL);
+      free(_threads[i].v);
+    }
+    free(_threads);
+    _threads = NULL;
+    SDL_DestroyCond(_start);
+    SDL_DestroyCond(_done);
+    SDL_DestroyMutex(_mutex);
+  }
+  free(_blockStart); _blockStart = NULL;
+  free(_blockList);  _blockList = NULL;
+  _listSize = _nbThreads = 0;
+}
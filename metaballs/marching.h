@@ -0,0 +1,10 @@
+#ifndef MARCHING_H
+#define MARCHING_H
+
+extern void        mcInit(int res, int nbThreads);
+extern int         mcPolygonise(const float * balls, int n, const float * lo, const float * hi, float iso);
+extern int         mcArenas(void);
+extern const float * mcArena(int i, int * nv);
+extern void        mcClean(void);
+
+#endif
@@ -0,0 +1,242 @@
+#include <assert.h>
+#include <string.h>
+#include "mobile.h"
+#include "metaball.h"
+#include "uploadHelper.h"
+#include "marching.h"
+
+/*!\brief side, in pixels, of a screen tile */
+#define TILE_SIZE 16
+/*!\brief resolution of the 3D field's grid */
+#define GRID_SIZE 128
+
+/*!\brief GLSL program Id */
+static GLuint _pId = 0;
+/*!\brief A generated Quad Id */
+static GLuint _quad = 0;
+/*!\brief CPU copy of the balls (color then position and support
+ * radius), needed to bin them */
+static GLfloat * _balls = NULL;
+/*!\brief per tile (offset, count) in \a _list, then the ball ids of
+ * all tiles one after the other */
+static GLint * _tiles = NULL, * _list = NULL;
+/*!\brief allocated sizes of the arrays above (in balls, tiles and
+ * ids) */
+static int _ballsSize = 0, _tilesSize = 0, _listSize = 0;
+/*!\brief upload rings of the three arrays */
+static uhRing_t * _ballsRing = NULL, * _tilesRing = NULL, * _listRing = NULL;
+/*!\brief 3D program, vertex array and buffer of the polygonised
+ * surface */
+static GLuint _p3Id = 0, _vao = 0, _vbo = 0;
+/*!\brief CPU copy of the 3D balls (position and support radius),
+ * allocated sizes of it and of the vertex buffer (in vertices) */
+static GLfloat * _balls3 = NULL;
+static int _balls3Size = 0, _vboSize = 0;
+
+/*!\brief initialises the metaball programs, quad, 3D vertex buffer
+ * and marching cubes' thread pool. */
+void mbInit(void) {
+  _pId = gl4duCreateProgram("<vs>shaders/attraction.vs", "<fs>shaders/metaballs.fs", NULL);
+  _p3Id = gl4duCreateProgram("<vs>shaders/metaballs3d.vs", "<fs>shaders/metaballs3d.fs", NULL);
+  _quad = gl4dgGenQuadf();
+  gl4duGenMatrix(GL_FLOAT, "modelViewMatrix");
+  gl4duGenMatrix(GL_FLOAT, "projectionMatrix");
+  glGenVertexArrays(1, &_vao);
+  glGenBuffers(1, &_vbo);
+  glBindVertexArray(_vao);
+  glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+  glEnableVertexAttribArray(0);
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (const void *)0);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (const void *)(3 * sizeof(GLfloat)));
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  mcInit(GRID_SIZE, 0);
+}
+
+/*!\brief makes sure the CPU arrays and their upload rings can hold
+ * \a n balls, \a t tiles and \a l ids. Only grows, so nothing is
+ * allocated once the animation is steady. */
+static void reserve(int n, int t, int l) {
+  if(n > _ballsSize) {
+    _ballsSize = n;
+    _balls = realloc(_balls, _ballsSize * 8 * sizeof *_balls);
+    assert(_balls);
+    uhDelete(_ballsRing);
+    _ballsRing = uhNew(_ballsSize * 8 * sizeof *_balls, GL_RGBA32F);
+  }
+  if(t > _tilesSize) {
+    _tilesSize = t;
+    _tiles = realloc(_tiles, _tilesSize * 2 * sizeof *_tiles);
+    assert(_tiles);
+    uhDelete(_tilesRing);
+    _tilesRing = uhNew(_tilesSize * 2 * sizeof *_tiles, GL_RG32I);
+  }
+  if(l > _listSize) {
+    _listSize = MAX(l, 2 * _listSize);
+    _list = realloc(_list, _listSize * sizeof *_list);
+    assert(_list);
+    uhDelete(_listRing);
+    _listRing = uhNew(_listSize * sizeof *_list, GL_R32I);
+  }
+}
+
+/*!\brief gives the range of tiles touched by the support of ball
+ * \a i, returns 0 if none. */
+static int ballTiles(int i, int tw, int th, int * b) {
+  const GLfloat * p = &_balls[8 * i + 4];
+  if(p[2] <= 0.0f)
+    return 0;
+  b[0] = MAX((int)floorf((p[0] - p[2]) / TILE_SIZE), 0);
+  b[1] = MAX((int)floorf((p[1] - p[2]) / TILE_SIZE), 0);
+  b[2] = MIN((int)floorf((p[0] + p[2]) / TILE_SIZE), tw - 1);
+  b[3] = MIN((int)floorf((p[1] + p[2]) / TILE_SIZE), th - 1);
+  return b[0] <= b[2] && b[1] <= b[3];
+}
+
+/*!\brief returns 1 if the support of ball \a i reaches tile (\a tx,
+ * \a ty). */
+static int ballInTile(int i, int tx, int ty) {
+  const GLfloat * p = &_balls[8 * i + 4];
+  float dx = MAX(MAX(tx * TILE_SIZE - p[0], p[0] - (tx + 1) * TILE_SIZE), 0.0f);
+  float dy = MAX(MAX(ty * TILE_SIZE - p[1], p[1] - (ty + 1) * TILE_SIZE), 0.0f);
+  return dx * dx + dy * dy < p[2] * p[2];
+}
+
+/*!\brief bins the \a n balls into the \a tw x \a th tiles (counting
+ * sort: count, prefix sum, fill).
+ * \return the total number of ids written in \a _list.
+ */
+static int bin(int n, int tw, int th) {
+  int i, t, tx, ty, b[4], total = 0;
+  memset(_tiles, 0, tw * th * 2 * sizeof *_tiles);
+  for(i = 0; i < n; i++) {
+    if(!ballTiles(i, tw, th, b)) continue;
+    for(ty = b[1]; ty <= b[3]; ty++)
+      for(tx = b[0]; tx <= b[2]; tx++)
+        if(ballInTile(i, tx, ty))
+          _tiles[2 * (ty * tw + tx) + 1]++;
+  }
+  for(t = 0; t < tw * th; t++) {
+    _tiles[2 * t] = total;
+    total += _tiles[2 * t + 1];
+    _tiles[2 * t + 1] = 0;
+  }
+  reserve(n, tw * th, total);
+  for(i = 0; i < n; i++) {
+    if(!ballTiles(i, tw, th, b)) continue;
+    for(ty = b[1]; ty <= b[3]; ty++)
+      for(tx = b[0]; tx <= b[2]; tx++)
+        if(ballInTile(i, tx, ty)) {
+          t = ty * tw + tx;
+          _list[_tiles[2 * t] + _tiles[2 * t + 1]++] = i;
+        }
+  }
+  return total;
+}
+
+/*!\brief draws the iso-surface of the \a n mobiles' field over a \a
+ * w x \a h viewport. Each fragment only sums the balls of its tile. */
+void mbDraw(int n, int w, int h) {
+  int tw = (w + TILE_SIZE - 1) / TILE_SIZE, th = (h + TILE_SIZE - 1) / TILE_SIZE, total;
+  if(n <= 0) return;
+  reserve(n, tw * th, 1);
+  mobile2texture(_balls);
+  total = bin(n, tw, th);
+
+  memcpy(uhMap(_ballsRing), _balls, n * 8 * sizeof *_balls);
+  memcpy(uhMap(_tilesRing), _tiles, tw * th * 2 * sizeof *_tiles);
+  memcpy(uhMap(_listRing), _list, total * sizeof *_list);
+
+  glUseProgram(_pId);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_BUFFER, uhCommit(_ballsRing));
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_BUFFER, uhCommit(_tilesRing));
+  glActiveTexture(GL_TEXTURE2);
+  glBindTexture(GL_TEXTURE_BUFFER, uhCommit(_listRing));
+  glUniform1i(glGetUniformLocation(_pId, "balls"), 0);
+  glUniform1i(glGetUniformLocation(_pId, "tiles"), 1);
+  glUniform1i(glGetUniformLocation(_pId, "list"), 2);
+  glUniform1i(glGetUniformLocation(_pId, "tileSize"), TILE_SIZE);
+  glUniform1i(glGetUniformLocation(_pId, "tilesWidth"), tw);
+  glUniform1f(glGetUniformLocation(_pId, "iso"), 0.5f);
+  gl4dgDraw(_quad);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+  glUseProgram(0);
+}
+
+/*!\brief polygonises the iso-surface of the \a n mobiles' 3D field
+ * in a \a w x \a h x min(\a w, \a h) box (marching cubes on the
+ * worker threads), uploads the arenas one after the other and draws
+ * the box slowly turning. */
+void mbDraw3D(int n, int w, int h) {
+  int i, nv, m, d = MIN(w, h);
+  GLfloat lo[3] = { 0.0f, 0.0f, 0.0f }, hi[3] = { w, h, d }, s = 1.0f / MAX(w, h);
+  GLintptr offset = 0;
+  const GLfloat * v;
+  if(n <= 0) return;
+  if(n > _balls3Size) {
+    _balls3Size = n;
+    _balls3 = realloc(_balls3, _balls3Size * 4 * sizeof *_balls3);
+    assert(_balls3);
+  }
+  mobile2balls(_balls3);
+  nv = mcPolygonise(_balls3, n, lo, hi, 0.5f);
+
+  glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+  if(nv > _vboSize)
+    _vboSize = MAX(nv, 2 * _vboSize);
+  /* orphans last frame's storage, then one copy per arena */
+  glBufferData(GL_ARRAY_BUFFER, _vboSize * 6 * sizeof(GLfloat), NULL, GL_STREAM_DRAW);
+  for(i = 0; i < mcArenas(); i++) {
+    v = mcArena(i, &m);
+    glBufferSubData(GL_ARRAY_BUFFER, offset, m * 6 * sizeof *v, v);
+    offset += m * 6 * sizeof *v;
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  gl4duBindMatrix("projectionMatrix");
+  gl4duLoadIdentityf();
+  gl4duFrustumf(-0.5, 0.5, -0.5 * h / w, 0.5 * h / w, 1.0, 1000.0);
+  gl4duBindMatrix("modelViewMatrix");
+  gl4duLoadIdentityf();
+  gl4duTranslatef(0, 0, -1.8f);
+  gl4duRotatef(SDL_GetTicks() * 0.01f, 0, 1, 0);
+  gl4duScalef(s, s, s);
+  gl4duTranslatef(-w / 2.0f, -h / 2.0f, -d / 2.0f);
+  glEnable(GL_DEPTH_TEST);
+  glClear(GL_DEPTH_BUFFER_BIT);
+  glUseProgram(_p3Id);
+  gl4duSendMatrices();
+  glUniform3f(glGetUniformLocation(_p3Id, "box"), w, h, d);
+  glBindVertexArray(_vao);
+  glDrawArrays(GL_TRIANGLES, 0, nv);
+  glBindVertexArray(0);
+  glUseProgram(0);
+  glDisable(GL_DEPTH_TEST);
+}
+
+/*!\brief deletes arrays, upload rings, the 3D buffers and the
+ * marching cubes' workers. */
+void mbClean(void) {
+  mcClean();
+  if(_vao) {
+    glDeleteVertexArrays(1, &_vao);
+    glDeleteBuffers(1, &_vbo);
+    _vao = _vbo = 0;
+  }
+  free(_balls3); _balls3 = NULL;
+  _balls3Size = _vboSize = 0;
+  uhDelete(_ballsRing); _ballsRing = NULL;
+  uhDelete(_tilesRing); _tilesRing = NULL;
+  uhDelete(_listRing);  _listRing = NULL;
+  free(_balls); _balls = NULL;
+  free(_tiles); _tiles = NULL;
+  free(_list);  _list = NULL;
+  _ballsSize = _tilesSize = _listSize = 0;
+}
@@ -0,0 +1,11 @@
+#ifndef METABALL_H
+#define METABALL_H
+
+#include <GL4D/gl4du.h>
+
+extern void mbInit(void);
+extern void mbDraw(int n, int w, int h);
+extern void mbDraw3D(int n, int w, int h);
+extern void mbClean(void);
+
+#endif
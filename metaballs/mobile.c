@@ -6,7 +6,7 @@ static int _dirx[] = { 0, -1, -1, 0, 1, 1,  1,  0, -1 };
 static int _diry[] = { 0,  0,  1, 1, 1, 0, -1, -1, -1 };
 static mobile_t * _mobile = NULL;
 static int _nbMobiles = 0;
-static int _w = 1, _h = 1;
+static int _w = 1, _h = 1, _d = 1;
 
 void mobileClean(void) {
   _nbMobiles = 0;
@@ -19,7 +19,7 @@ void mobileClean(void) {
 void mobileInit(int n, int w, int h) {
   srand(time(NULL));
   int i;
-  _w = w; _h = h;
+  _w = w; _h = h; _d = MIN(w, h);
   _nbMobiles = n;
 
   if(_mobile) {
@@ -31,16 +31,26 @@ void mobileInit(int n, int w, int h) {
   assert(_mobile);
 
   for(i = 0; i < _nbMobiles; i++) {
-    _mobile[i].r = (!i ? 50.0 : 10.0);
+    _mobile[i].r = (!i ? 50.0 : 3.0 + 6.0 * gl4dmURand());
     _mobile[i].x = (!i ? _w/2 : gl4dmURand() * _w);
     _mobile[i].y = (!i ? _h/2 : gl4dmURand() * _h);
+    _mobile[i].z = (!i ? _d/2 : gl4dmURand() * _d);
     _mobile[i].color[0] = gl4dmURand();
     _mobile[i].color[1] = gl4dmURand();
     _mobile[i].color[2] = gl4dmURand();
+    _mobile[i].vx = 4.0 * gl4dmURand() - 2.0;
+    _mobile[i].vy = 4.0 * gl4dmURand() - 2.0;
+    _mobile[i].vz = 4.0 * gl4dmURand() - 2.0;
     _mobile[i].alive = 1;
   }
 }
 
+void mobileResize(int w, int h) {
+  _w = w; _h = h; _d = MIN(w, h);
+}
+
+/* writes, for each mobile, its color then its position (in pixels)
+ * and the radius of its field's support (twice its radius) */
 void mobile2texture(float * f) {
   int i;
   for(i = 0; i < _nbMobiles; i++) {
@@ -48,13 +58,27 @@ void mobile2texture(float * f) {
     f[8 * i + 1] = _mobile[i].color[1];
     f[8 * i + 2] = _mobile[i].color[2];
     f[8 * i + 3] = 1;
-    f[8 * i + 4] = _mobile[i].x / _w;
-    f[8 * i + 5] = _mobile[i].y / _h;
-    f[8 * i + 6] = _mobile[i].r / ((GLfloat)MIN(_w, _h));
+    f[8 * i + 4] = _mobile[i].x;
+    f[8 * i + 5] = _mobile[i].y;
+    f[8 * i + 6] = 2.0f * _mobile[i].r;
     f[8 * i + 7] = 1;
   }
 }
 
+/* writes, for each mobile, its position (in pixels, z in [0, depth])
+ * and the radius of its 3D field's support. The 3D grid is coarser
+ * than the screen so balls are three times as wide as in 2D, the big
+ * central one being clamped to the size of the others */
+void mobile2balls(float * f) {
+  int i;
+  for(i = 0; i < _nbMobiles; i++) {
+    f[4 * i + 0] = _mobile[i].x;
+    f[4 * i + 1] = _mobile[i].y;
+    f[4 * i + 2] = _mobile[i].z;
+    f[4 * i + 3] = 6.0f * MIN(_mobile[i].r, 9.0f);
+  }
+}
+
 int distance(int x0, int y0, int x1, int y1) {
   return sqrt((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0));
 }
@@ -99,3 +123,20 @@ void mobileMove(void) {
       _mobile[0].r += 0.005;
   }
 }
+
+/* moves the mobiles along their speed, bouncing on the window borders
+ * (and on the depth of the 3D box) */
+void mobileBounce(void) {
+  int i;
+  for(i = 0; i < _nbMobiles; i++) {
+    _mobile[i].x += _mobile[i].vx;
+    _mobile[i].y += _mobile[i].vy;
+    _mobile[i].z += _mobile[i].vz;
+    if((_mobile[i].x < 0 && _mobile[i].vx < 0) || (_mobile[i].x > _w && _mobile[i].vx > 0))
+      _mobile[i].vx = -_mobile[i].vx;
+    if((_mobile[i].y < 0 && _mobile[i].vy < 0) || (_mobile[i].y > _h && _mobile[i].vy > 0))
+      _mobile[i].vy = -_mobile[i].vy;
+    if((_mobile[i].z < 0 && _mobile[i].vz < 0) || (_mobile[i].z > _d && _mobile[i].vz > 0))
+      _mobile[i].vz = -_mobile[i].vz;
+  }
+}
@@ -6,7 +6,7 @@
 
 typedef struct mobile_t mobile_t;
 struct mobile_t {
-  double x, y, vx, vy;
+  double x, y, z, vx, vy, vz;
   float color[3];
   float r;
   int alive;
@@ -14,8 +14,11 @@ struct mobile_t {
 
 extern void mobileIntersect(void);
 extern void mobile2texture(float * f);
+extern void mobile2balls(float * f);
 extern void mobileInit(int n, int w, int h);
 extern void mobileMove(void);
+extern void mobileBounce(void);
+extern void mobileResize(int w, int h);
 extern void mobileClean(void);
 
 #endif
@@ -0,0 +1,36 @@
+#version 330
+uniform samplerBuffer balls;
+uniform isamplerBuffer tiles;
+uniform isamplerBuffer list;
+uniform int tileSize;
+uniform int tilesWidth;
+uniform float iso;
+out vec4 fragColor;
+
+/* each ball contributes (1 - d^2/R^2)^3 inside its support of radius
+ * R, the field and its gradient are summed over the balls binned in
+ * the fragment's tile only */
+void main(void) {
+  ivec2 t = ivec2(gl_FragCoord.xy) / tileSize;
+  ivec2 range = texelFetch(tiles, t.y * tilesWidth + t.x).xy;
+  vec2 p = gl_FragCoord.xy, g = vec2(0);
+  vec3 c = vec3(0), n, l = normalize(vec3(-1, 1, 2));
+  float f = 0.0, spec;
+  for(int i = range.x; i < range.x + range.y; i++) {
+    int id = texelFetch(list, i).x;
+    vec3 b = texelFetch(balls, 2 * id + 1).xyz;
+    vec2 d = p - b.xy;
+    float ir2 = 1.0 / (b.z * b.z), q = 1.0 - dot(d, d) * ir2;
+    if(q <= 0.0)
+      continue;
+    f += q * q * q;
+    g -= 6.0 * q * q * ir2 * d;
+    c += q * q * q * texelFetch(balls, 2 * id).rgb;
+  }
+  if(f < iso)
+    discard;
+  /* analytic normal of the height field z = f(x, y) */
+  n = normalize(vec3(-4.0 * g, 1.0));
+  spec = pow(max(dot(reflect(-l, n), vec3(0, 0, 1)), 0.0), 20.0);
+  fragColor = vec4((c / f) * (0.3 + 0.7 * max(dot(n, l), 0.0)) + vec3(spec), 1.0);
+}
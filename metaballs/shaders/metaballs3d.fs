@@ -0,0 +1,14 @@
+#version 330
+in vec3 vsoNormal;
+in vec3 vsoModPos;
+in vec3 vsoColor;
+out vec4 fragColor;
+
+void main(void) {
+  vec3 n = normalize(vsoNormal), l = normalize(vec3(-1, 1, 1)), v = normalize(-vsoModPos);
+  float spec;
+  if(!gl_FrontFacing)
+    n = -n;
+  spec = pow(max(dot(reflect(-l, n), v), 0.0), 20.0);
+  fragColor = vec4(vsoColor * (0.3 + 0.7 * max(dot(n, l), 0.0)) + vec3(spec), 1.0);
+}
@@ -0,0 +1,19 @@
+#version 330
+uniform mat4 modelViewMatrix;
+uniform mat4 projectionMatrix;
+uniform vec3 box;
+layout (location = 0) in vec3 vsiPosition;
+layout (location = 1) in vec3 vsiNormal;
+out vec3 vsoNormal;
+out vec3 vsoModPos;
+out vec3 vsoColor;
+
+void main(void) {
+  vec4 mp = modelViewMatrix * vec4(vsiPosition, 1.0);
+  /* the model-view only rotates and uniformly scales */
+  vsoNormal = mat3(modelViewMatrix) * vsiNormal;
+  vsoModPos = mp.xyz;
+  /* colour follows the position in the box */
+  vsoColor = mix(vec3(0.9, 0.2, 0.3), vec3(0.2, 0.4, 0.9), vsiPosition / box);
+  gl_Position = projectionMatrix * mp;
+}
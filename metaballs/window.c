@@ -1,4 +1,5 @@
 #include "mobile.h"
+#include "metaball.h"
 
 static void init(void);
 static void resize(int w, int h);
@@ -13,6 +14,10 @@ static GLuint _pId = 0;
 static int _basses = 0;
 /*!\brief A generated Quad Id */
 static GLuint _quad = 0;
+/*!\brief number of metaballs to simulate in 2D and in 3D */
+static const int _nbMobiles = 2000, _nbMobiles3D = 1000;
+/*!\brief 1 to polygonise the 3D field, 0 for the 2D metaballs */
+static int _3d = 0;
 
 /*!\brief main function, creates the window, initialise OpenGL
  *  parameters and objects, sets GL4Dummies callback function and
@@ -41,9 +46,14 @@ static void init(void) {
   resize(_windowWidth, _windowHeight);
   /* generating a Quad (Vertex coords + Vertex Normal + Vertex TexCoord */
   _quad = gl4dgGenQuadf();
-  /* creating a 1D texture to store mobile coords */
-  glBindTexture(GL_TEXTURE_1D, 0);
-  /* calling mobileInit */
+  /* metaballs program and mobiles */
+  mbInit();
+  mobileInit(_nbMobiles, _windowWidth, _windowHeight);
+}
+
+/*!\brief number of mobiles of the current mode */
+static int nbMobiles(void) {
+  return _3d ? _nbMobiles3D : _nbMobiles;
 }
 
 /*!\brief sets the OpenGL viewport according to the window width and height.
@@ -52,6 +62,7 @@ static void resize(int w, int h) {
   _windowWidth  = w;
   _windowHeight = h;
   glViewport(0, 0, _windowWidth, _windowHeight);
+  mobileResize(_windowWidth, _windowHeight);
 }
 
 /*!\brief manages keyboard-down event */
@@ -60,6 +71,12 @@ static void keydown(int keycode) {
   case SDLK_ESCAPE:
   case 'q':
     exit(0);
+  case 'm':
+    _3d = !_3d;
+    /* fall through */
+  case 'r':
+    mobileInit(nbMobiles(), _windowWidth, _windowHeight);
+    break;
   }
 }
 
@@ -77,13 +94,21 @@ static void draw(void) {
 
   gl4dgDraw(_quad);
   glBindVertexArray(0);
-  glBindTexture(GL_TEXTURE_1D, 0);
   glUseProgram(0);
+
+  /* metaballs over the background */
+  mobileBounce();
+  if(_3d)
+    mbDraw3D(_nbMobiles3D, _windowWidth, _windowHeight);
+  else
+    mbDraw(_nbMobiles, _windowWidth, _windowHeight);
   onde -= 0.01;
   if(onde < 0) onde = 3.0;
 }
 
 /*!\brief called at exit and delete and clean used data. */
 static void quit(void) {
+  mbClean();
+  mobileClean();
   gl4duClean(GL4DU_ALL);
 }
@@ -2,78 +2,223 @@
 #include <assert.h>
 #include "mobile.h"
 
+/*!\brief côté (en pixels) d'une cellule de la grille */
+#define CELL_SIZE 8
+/*!\brief nombre de germes tentés à chaque frame */
+#define SEEDS_PER_FRAME 1024
+/*!\brief nombre d'essais par germe et par frame */
+#define SEED_TRIES 8
+/*!\brief nombre d'échecs au-delà duquel une cellule est considérée
+ * pleine */
+#define CELL_MISSES 32
+
+/*!\brief cellule de la grille : liste des cercles qui la
+ * chevauchent, position dans la liste des cellules libres et nombre
+ * de germes refusés */
+typedef struct cell_t cell_t;
+struct cell_t {
+  int * ids;
+  int n, size;
+  int free, miss;
+};
+
 static mobile_t * _mobile = NULL;
 static int _nbMobiles = 0;
 static int _curMobile = 0;
 
-void mobileInit(int n) {
-  srand(time(NULL));
-  int i;
-  _nbMobiles = n;
+/*!\brief grille de hachage spatial uniforme */
+static cell_t * _grid = NULL;
+static int _gw = 0, _gh = 0;
+/*!\brief rectangle de cellules où chaque cercle est déjà inséré */
+static int * _cbox = NULL;
+/*!\brief cellules non entièrement recouvertes, où l'on tire les germes */
+static int * _free = NULL;
+static int _nbFree = 0;
+/*!\brief marqueurs évitant de tester deux fois le même voisin */
+static unsigned * _stamp = NULL;
+static unsigned _query = 0;
 
-  if(_mobile) {
-    free(_mobile);
-    _mobile = NULL;
+static void cellAdd(cell_t * c, int id) {
+  if(c->n == c->size) {
+    c->size = c->size ? 2 * c->size : 4;
+    c->ids = realloc(c->ids, c->size * sizeof *c->ids);
+    assert(c->ids);
   }
+  c->ids[c->n++] = id;
+}
 
-  _mobile = malloc(_nbMobiles * sizeof *_mobile);
-  assert(_mobile);
-  for(i = 0; i < _nbMobiles; i++) {
-    _mobile[i].r = 1;
-    do {
-      _mobile[i].x = gl4dmURand() * gl4dpGetWidth();
-      _mobile[i].y = gl4dmURand() * gl4dpGetHeight();
-    } while (gl4dpGetPixel(_mobile[i].x, _mobile[i].y) != 0);
-    _mobile[i].c = RGB(255, 255, 255);
-    _mobile[i].alive = 1;
+/*!\brief retire la cellule \a ci de la liste des cellules libres */
+static void freeRemove(int ci) {
+  int k = _grid[ci].free, last = _free[--_nbFree];
+  _free[k] = last;
+  _grid[last].free = k;
+  _grid[ci].free = -1;
+}
+
+/*!\brief calcule le rectangle de cellules couvert par le disque
+ * (\a x, \a y, \a r) */
+static void cellRange(float x, float y, float r, int * b) {
+  b[0] = (int)((x - r) / CELL_SIZE); if(b[0] < 0) b[0] = 0;
+  b[1] = (int)((y - r) / CELL_SIZE); if(b[1] < 0) b[1] = 0;
+  b[2] = (int)((x + r) / CELL_SIZE); if(b[2] > _gw - 1) b[2] = _gw - 1;
+  b[3] = (int)((y + r) / CELL_SIZE); if(b[3] > _gh - 1) b[3] = _gh - 1;
+}
+
+/*!\brief insère le cercle \a id dans les cellules nouvellement
+ * couvertes par son rayon courant et retire de l'espace libre celles
+ * qu'il recouvre entièrement. */
+static void gridUpdate(int id) {
+  int cx, cy, b[4], * o = &_cbox[4 * id];
+  mobile_t * m = &_mobile[id];
+  float r2 = m->r * m->r;
+  cellRange(m->x, m->y, m->r, b);
+  for(cy = b[1]; cy <= b[3]; cy++) {
+    for(cx = b[0]; cx <= b[2]; cx++) {
+      int ci = cy * _gw + cx;
+      if(cx < o[0] || cx > o[2] || cy < o[1] || cy > o[3])
+        cellAdd(&_grid[ci], id);
+      if(_grid[ci].free >= 0) {
+        /* recouverte si son coin le plus éloigné est dans le disque */
+        float dx = MAX(fabsf(cx * CELL_SIZE - m->x), fabsf((cx + 1) * CELL_SIZE - m->x));
+        float dy = MAX(fabsf(cy * CELL_SIZE - m->y), fabsf((cy + 1) * CELL_SIZE - m->y));
+        if(dx * dx + dy * dy <= r2)
+          freeRemove(ci);
+      }
+    }
   }
+  o[0] = b[0]; o[1] = b[1]; o[2] = b[2]; o[3] = b[3];
 }
 
-static void mobileIntersect(double dt) {
-  int i, j;
-  float dx, dy, d, de;
-  if(_curMobile < _nbMobiles)
-    _curMobile++;
-  for(i = 0; i < _curMobile; i++) {
-    for(j = i + 1; j < _curMobile; j++) {
-      dx = _mobile[i].x - _mobile[j].x;
-      dy = _mobile[i].y - _mobile[j].y;
-      d = _mobile[i].r + _mobile[j].r + 1;
-      if((de = dx * dx + dy * dy) < d * d) {
-        _mobile[i].alive = 0;
-        _mobile[j].alive = 0;
+/*!\brief cherche un cercle (autre que \a self) en contact avec le
+ * disque (\a x, \a y, \a r).
+ * \return l'indice du premier cercle trouvé, -1 sinon.
+ */
+static int gridQuery(float x, float y, float r, int self) {
+  int cx, cy, k, b[4];
+  ++_query;
+  cellRange(x, y, r + 1, b);
+  for(cy = b[1]; cy <= b[3]; cy++) {
+    for(cx = b[0]; cx <= b[2]; cx++) {
+      cell_t * c = &_grid[cy * _gw + cx];
+      for(k = 0; k < c->n; k++) {
+        int j = c->ids[k];
+        float dx, dy, d;
+        if(j == self || _stamp[j] == _query) continue;
+        _stamp[j] = _query;
+        dx = x - _mobile[j].x;
+        dy = y - _mobile[j].y;
+        d = r + _mobile[j].r + 1;
+        if(dx * dx + dy * dy < d * d)
+          return j;
       }
     }
   }
+  return -1;
 }
 
-void mobileGrow(void) {
+/*!\brief tente de placer un nouveau germe dans une cellule libre
+ * tirée au hasard. Une cellule est retirée de l'espace libre dès
+ * qu'elle est recouverte par un disque ou après CELL_MISSES refus
+ * (elle est alors saturée par plusieurs disques).
+ * \return 1 si le germe a pu être placé, 0 sinon.
+ */
+static int mobileSeed(void) {
+  int ci = _free[(int)(gl4dmURand() * _nbFree)];
+  mobile_t * m = &_mobile[_curMobile];
+  m->x = (ci % _gw + gl4dmURand()) * CELL_SIZE;
+  m->y = (ci / _gw + gl4dmURand()) * CELL_SIZE;
+  m->r = 1;
+  if(m->x >= gl4dpGetWidth() || m->y >= gl4dpGetHeight() ||
+     gridQuery(m->x, m->y, m->r, _curMobile) >= 0) {
+    if(++_grid[ci].miss >= CELL_MISSES)
+      freeRemove(ci);
+    return 0;
+  }
+  m->c = RGB(255, 255, 255);
+  m->alive = 1;
+  m->drawn = 0;
+  _cbox[4 * _curMobile + 0] = _cbox[4 * _curMobile + 1] = 1;
+  _cbox[4 * _curMobile + 2] = _cbox[4 * _curMobile + 3] = 0;
+  gridUpdate(_curMobile++);
+  return 1;
+}
+
+void mobileInit(int n) {
+  srand(time(NULL));
   int i;
-  static Uint32 t0 = 0;
-  Uint32 t = SDL_GetTicks();
-  double dt = (t - t0) / 1000.0;
-  t0 = t;
+  mobileDelete();
+  _nbMobiles = n;
+  _curMobile = 0;
+
+  _mobile = malloc(_nbMobiles * sizeof *_mobile);
+  assert(_mobile);
+  _cbox = malloc(4 * _nbMobiles * sizeof *_cbox);
+  assert(_cbox);
+  _stamp = calloc(_nbMobiles, sizeof *_stamp);
+  assert(_stamp);
+  _query = 0;
+
+  _gw = (gl4dpGetWidth()  + CELL_SIZE - 1) / CELL_SIZE;
+  _gh = (gl4dpGetHeight() + CELL_SIZE - 1) / CELL_SIZE;
+  _grid = calloc(_gw * _gh, sizeof *_grid);
+  assert(_grid);
+  _free = malloc(_gw * _gh * sizeof *_free);
+  assert(_free);
+  for(i = 0; i < _gw * _gh; i++)
+    _free[_grid[i].free = i] = i;
+  _nbFree = _gw * _gh;
+  gl4dpClearScreen();
+}
+
+void mobileGrow(void) {
+  int i, j, n = 0;
+  for(i = 0; i < SEEDS_PER_FRAME * SEED_TRIES && n < SEEDS_PER_FRAME &&
+        _curMobile < _nbMobiles && _nbFree; i++)
+    n += mobileSeed();
 
-  mobileIntersect(dt);
   for(i = 0; i < _curMobile; i++) {
-    if((!(_mobile[i].x + _mobile[i].r > gl4dpGetWidth() ||
-       _mobile[i].x - _mobile[i].r < 0 ||
-       _mobile[i].y + _mobile[i].r > gl4dpGetHeight() ||
-       _mobile[i].y - _mobile[i].r < 0)) &&
-       _mobile[i].alive)
-      _mobile[i].r += 0.5;
+    mobile_t * m = &_mobile[i];
+    if(!m->alive)
+      continue;
+    if(m->x + m->r > gl4dpGetWidth() || m->x - m->r < 0 ||
+       m->y + m->r > gl4dpGetHeight() || m->y - m->r < 0)
+      continue;
+    /* croissance jusqu'au contact : les deux cercles s'arrêtent */
+    if((j = gridQuery(m->x, m->y, m->r, i)) >= 0) {
+      m->alive = 0;
+      _mobile[j].alive = 0;
+      continue;
+    }
+    m->r += 0.5;
+    gridUpdate(i);
   }
 }
 
+/*!\brief les cercles ne faisant que grandir, seuls ceux dont le rayon
+ * a changé depuis la dernière frame sont redessinés. */
 void mobileDraw(void) {
   int i;
   for(i = 0; i < _curMobile; i++) {
+    if(_mobile[i].drawn == _mobile[i].r)
+      continue;
     gl4dpSetColor(_mobile[i].c);
     gl4dpFilledCircle(_mobile[i].x, _mobile[i].y, _mobile[i].r);
+    _mobile[i].drawn = _mobile[i].r;
   }
 }
 
 void mobileDelete(void) {
+  int i;
+  if(_grid) {
+    for(i = 0; i < _gw * _gh; i++)
+      free(_grid[i].ids);
+    free(_grid);
+    _grid = NULL;
+  }
+  free(_free);  _free = NULL;
+  free(_cbox);  _cbox = NULL;
+  free(_stamp); _stamp = NULL;
+  _nbFree = 0;
   if(_mobile) {
     free(_mobile);
     _mobile = NULL;
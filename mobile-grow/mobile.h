@@ -10,7 +10,7 @@
 
 typedef struct mobile_t mobile_t;
 struct mobile_t {
-  float x, y, r;
+  float x, y, r, drawn;
   float color[3];
   int alive;
   GLuint c;
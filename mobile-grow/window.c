@@ -6,7 +6,6 @@ static void quit(void) {
 }
 
 static void draw(void) {
-  gl4dpClearScreen();
   mobileDraw();
   gl4dpUpdateScreen(NULL);
 }
@@ -23,7 +22,7 @@ int main(int argc, char ** argv) {
   gl4dpInitScreen();
   gl4duwIdleFunc(mobileGrow);
   gl4duwDisplayFunc(draw);
-  mobileInit(200);
+  mobileInit(100000);
   gl4duwMainLoop();
 
   return 0;
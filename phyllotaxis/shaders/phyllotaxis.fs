@@ -0,0 +1,12 @@
+#version 330
+in vec3 vsoColor;
+in float vsoAlpha;
+out vec4 fragColor;
+
+void main(void) {
+  /* points ronds */
+  vec2 d = 2.0 * gl_PointCoord - 1.0;
+  if(dot(d, d) > 1.0)
+    discard;
+  fragColor = vec4(vsoColor * vsoAlpha, 1.0);
+}
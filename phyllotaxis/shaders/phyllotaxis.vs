@@ -0,0 +1,41 @@
+#version 330
+/* fractions de tour de form / 2pi, 256 * form / 2pi et 65536 * form
+ * / 2pi, calculées en double précision côté CPU */
+uniform vec3 turns;
+/* nombre de points (réel pour l'apparition progressive du dernier) */
+uniform float count;
+/* coefficient du rayon (c) en pixels et dimensions de la fenêtre */
+uniform float c;
+uniform vec2 dim;
+out vec3 vsoColor;
+out float vsoAlpha;
+
+/* hachage entier (Wang) donnant une couleur stable par point */
+uint hash(uint x) {
+  x = (x ^ 61u) ^ (x >> 16);
+  x *= 9u;
+  x = x ^ (x >> 4);
+  x *= 0x27d4eb2du;
+  return x ^ (x >> 15);
+}
+
+void main(void) {
+  int n = gl_VertexID;
+  /* angle n * form réduit modulo 2pi sans perte de précision : n est
+   * découpé en trois octets dont chaque produit reste petit */
+  float t = fract(float(n & 255) * turns.x) +
+            fract(float((n >> 8) & 255) * turns.y) +
+            fract(float(n >> 16) * turns.z);
+  float a = 6.28318530718 * fract(t);
+  vec2 p = c * sqrt(float(n)) * vec2(cos(a), sin(a));
+  gl_Position = vec4(2.0 * p / dim, 0.0, 1.0);
+  gl_PointSize = max(1.0, 0.4 * c);
+  /* un point sur deux est blanc, les autres prennent une couleur hachée */
+  if((n & 1) == 0)
+    vsoColor = vec3(1.0);
+  else {
+    uint h = hash(uint(n));
+    vsoColor = vec3(h & 255u, (h >> 8) & 255u, (h >> 16) & 255u) / 255.0;
+  }
+  vsoAlpha = clamp(count - float(n), 0.0, 1.0);
+}
@@ -2,15 +2,57 @@
 #include <GL4D/gl4du.h>
 #include <GL4D/gl4duw_SDL2.h>
 #include <assert.h>
+#include <math.h>
+
+/*!\brief nombre maximal de points du mode GPU (les indices sont
+ * découpés en trois octets dans le vertex shader) */
+#define MAX_POINTS (1 << 24)
+
+static void quit(void);
+static void resize(int w, int h);
+static void keydown(int keycode);
+
+/*!\brief paramètres de la phyllotaxie */
+static const float _c = 10.0f, _form = 136.5f;
+/*!\brief dimensions de la fenêtre */
+static int _wW = 800, _wH = 600;
+/*!\brief vaut 1 pour le mode GPU, 0 pour le mode historique
+ * (un cercle par frame dans l'écran gl4dp) */
+static int _gpu = 1;
+/*!\brief programme et VAO (vide) du mode GPU */
+static GLuint _pId = 0, _vao = 0;
+/*!\brief nombre de points affichés en mode GPU */
+static float _count = 1.0f;
 
 static void quit(void) {
+  if(_vao) {
+    glDeleteVertexArrays(1, &_vao);
+    _vao = 0;
+  }
   gl4duClean(GL4DU_ALL);
 }
 
+static void resize(int w, int h) {
+  _wW = w; _wH = h;
+  glViewport(0, 0, _wW, _wH);
+}
+
+static void keydown(int keycode) {
+  switch(keycode) {
+  case 'g':
+    _gpu = !_gpu;
+    break;
+  case SDLK_ESCAPE:
+  case 'q':
+    exit(0);
+  default: break;
+  }
+}
+
 static void phyllotaxis(void) {
   static float n = 0.0;
   static int color_state = 0;
-  float c = 10.0, form = 136.5;
+  float c = _c, form = _form;
   GLubyte r, g, b;
 
   float a = n * form;
@@ -27,7 +69,40 @@ static void phyllotaxis(void) {
   n++;
 }
 
+/*!\brief mode GPU : chaque point est calculé à partir de gl_VertexID,
+ * tout le motif est dessiné en un seul appel et l'animation se
+ * résume à faire croître \a _count. Le coefficient du rayon est
+ * réduit lorsque le motif dépasse la fenêtre. */
+static void phyllotaxisGPU(void) {
+  static Uint32 t0 = 0;
+  Uint32 t = SDL_GetTicks();
+  double k = _form / (2.0 * M_PI);
+  float c, rmax = 0.48f * MIN(_wW, _wH);
+  if(t0)
+    _count = MIN(_count * pow(1.01, (t - t0) * 0.06) + 1.0, MAX_POINTS);
+  t0 = t;
+  c = MIN(_c, rmax / sqrtf(_count));
+
+  glClear(GL_COLOR_BUFFER_BIT);
+  glEnable(GL_PROGRAM_POINT_SIZE);
+  glUseProgram(_pId);
+  glUniform3f(glGetUniformLocation(_pId, "turns"),
+              k - floor(k), 256.0 * k - floor(256.0 * k), 65536.0 * k - floor(65536.0 * k));
+  glUniform1f(glGetUniformLocation(_pId, "count"), _count);
+  glUniform1f(glGetUniformLocation(_pId, "c"), c);
+  glUniform2f(glGetUniformLocation(_pId, "dim"), _wW, _wH);
+  glBindVertexArray(_vao);
+  glDrawArrays(GL_POINTS, 0, (GLsizei)ceilf(_count));
+  glBindVertexArray(0);
+  glUseProgram(0);
+  glDisable(GL_PROGRAM_POINT_SIZE);
+}
+
 static void draw(void) {
+  if(_gpu) {
+    phyllotaxisGPU();
+    return;
+  }
   phyllotaxis();
   gl4dpUpdateScreen(NULL);
 }
@@ -35,13 +110,18 @@ static void draw(void) {
 int main(int argc, char ** argv) {
   if(!gl4duwCreateWindow(argc, argv,
 			 "phyllotaxis",
-			 10, 10, 800, 600,
-			 GL4DW_SHOWN)) {
+			 10, 10, _wW, _wH,
+			 GL4DW_RESIZABLE | GL4DW_SHOWN)) {
     return 1;
   }
 
   atexit(quit);
   gl4dpInitScreen();
+  _pId = gl4duCreateProgram("<vs>shaders/phyllotaxis.vs", "<fs>shaders/phyllotaxis.fs", NULL);
+  glGenVertexArrays(1, &_vao);
+  glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+  gl4duwResizeFunc(resize);
+  gl4duwKeyDownFunc(keydown);
   gl4duwDisplayFunc(draw);
   gl4duwMainLoop();
 
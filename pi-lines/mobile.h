@@ -14,5 +14,6 @@ struct mobile_t {
 
 extern void mobileInit(void);
 extern void mobileDraw(void);
+extern void mobileDelete(void);
 
 #endif
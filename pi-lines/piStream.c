@@ -0,0 +1,182 @@
+#include "piStream.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <SDL.h>
+
+/*!\brief capacité (puissance de 2) de l'anneau de décimales ; elle
+ * couvre le recalcul des décimales déjà émises lors du passage à la
+ * génération suivante du spigot */
+#define RING_SIZE (1 << 20)
+/*!\brief nombre de décimales de la première génération du spigot */
+#define FIRST_GEN 1024
+/*!\brief base du spigot : quatre décimales par itération */
+#define BASE 10000
+/*!\brief décimales calculées au-delà de celles émises, les dernières
+ * d'une génération pouvant être fausses */
+#define MARGIN 16
+
+/*!\brief anneau producteur / consommateur sans verrou : seul le
+ * thread de calcul écrit \a _head, seule la boucle d'affichage écrit
+ * \a _tail */
+static char _ring[RING_SIZE];
+static SDL_atomic_t _head, _tail;
+/*!\brief demande d'arrêt du thread de calcul */
+static SDL_atomic_t _quit;
+static SDL_Thread * _thread = NULL;
+/*!\brief fichier cache des décimales calculées (peut être NULL) */
+static FILE * _cache = NULL;
+static char * _cacheName = NULL;
+
+/*!\brief pousse la décimale \a d dans l'anneau, en attendant
+ * (uniquement côté producteur) qu'une place se libère.
+ * \return 0 si un arrêt a été demandé, 1 sinon.
+ */
+static int push(int d) {
+  int h = SDL_AtomicGet(&_head);
+  while(h - SDL_AtomicGet(&_tail) >= RING_SIZE) {
+    if(SDL_AtomicGet(&_quit))
+      return 0;
+    SDL_Delay(10);
+  }
+  _ring[h & (RING_SIZE - 1)] = d;
+  SDL_AtomicSet(&_head, h + 1);
+  return !SDL_AtomicGet(&_quit);
+}
+
+/*!\brief émet la décimale de rang \a i si elle n'a pas déjà été
+ * émise (\a i >= \a *emitted), et l'ajoute au cache.
+ * \return 0 si un arrêt a été demandé, 1 sinon.
+ */
+static int emit(int i, int d, int * emitted) {
+  if(i < *emitted)
+    return !SDL_AtomicGet(&_quit);
+  if(_cache)
+    fputc('0' + d, _cache);
+  ++*emitted;
+  return push(d);
+}
+
+/*!\brief spigot de Rabinowitz-Wagon en base 10000 (variante de
+ * D. Winter) calculant les \a n premières décimales. Les groupes de
+ * quatre décimales sont émis au fil du calcul ; un groupe n'est libéré
+ * qu'une fois connue l'éventuelle retenue du suivant (les groupes 9999
+ * restent en attente avec lui).
+ * \return 0 si un arrêt a été demandé, 1 sinon.
+ */
+static int spigot(int n, int * emitted) {
+  int b, c = 14 * ((n + MARGIN + 3) / 4), i = 0, k, nh = 0, held[64];
+  long long d, e = 0, g;
+  int * f = malloc((c + 1) * sizeof *f);
+  assert(f);
+  for(b = 0; b <= c; b++)
+    f[b] = BASE / 5;
+  for(; c > 0; c -= 14) {
+    int v;
+    d = 0;
+    g = 2 * c;
+    for(b = c; ; ) {
+      d += (long long)f[b] * BASE;
+      f[b] = d % --g;
+      d /= g--;
+      if(!--b) break;
+      d *= b;
+    }
+    v = (int)(e + d / BASE);
+    e = d % BASE;
+    if(v >= BASE) {
+      v -= BASE;
+      for(k = nh - 1; k >= 0 && ++held[k] == BASE; k--)
+        held[k] = 0;
+    }
+    if(v != BASE - 1 || nh == 64) {
+      for(k = 0; k < nh; k++) {
+        int j, p = 1000;
+        for(j = 0; j < 4 && i < n; j++, p /= 10)
+          if(!emit(i++, (held[k] / p) % 10, emitted)) {
+            free(f);
+            return 0;
+          }
+      }
+      nh = 0;
+    }
+    held[nh++] = v;
+  }
+  free(f);
+  return 1;
+}
+
+/*!\brief thread de calcul : relit le cache puis enchaîne des
+ * générations de spigot de tailles doublées, chacune n'émettant que
+ * les décimales qui suivent celles déjà produites (les derniers
+ * groupes en attente sont jetés et recalculés par la génération
+ * suivante). */
+static int producer(void * data) {
+  int c, n, emitted = 0;
+  FILE * in;
+  (void)data;
+  if(_cacheName && (in = fopen(_cacheName, "r"))) {
+    while((c = fgetc(in)) >= '0' && c <= '9') {
+      ++emitted;
+      if(!push(c - '0')) {
+        fclose(in);
+        return 0;
+      }
+    }
+    fclose(in);
+  }
+  if(_cacheName && !(_cache = fopen(_cacheName, "a")))
+    fprintf(stderr, "%s (%s:%d): impossible d'ouvrir le cache %s\n",
+            __func__, __FILE__, __LINE__, _cacheName);
+  for(n = FIRST_GEN; n <= 2 * emitted; n *= 2);
+  for(; n > 0; n *= 2)
+    if(!spigot(n, &emitted))
+      break;
+  return 0;
+}
+
+/*!\brief lance le calcul des décimales de pi en tâche de fond. Si
+ * \a cache n'est pas NULL, les décimales déjà présentes dans ce
+ * fichier sont servies en premier et les nouvelles y sont ajoutées. */
+void psInit(const char * cache) {
+  psClean();
+  SDL_AtomicSet(&_head, 0);
+  SDL_AtomicSet(&_tail, 0);
+  SDL_AtomicSet(&_quit, 0);
+  if(cache) {
+    _cacheName = malloc(strlen(cache) + 1);
+    assert(_cacheName);
+    strcpy(_cacheName, cache);
+  }
+  _thread = SDL_CreateThread(producer, "piDigits", NULL);
+  assert(_thread);
+}
+
+/*!\brief renvoie la décimale suivante de pi (3, 1, 4, 1, ...), ou -1
+ * si aucune n'est encore disponible ; n'attend jamais. */
+int psNext(void) {
+  int d, t = SDL_AtomicGet(&_tail);
+  if(t == SDL_AtomicGet(&_head))
+    return -1;
+  d = _ring[t & (RING_SIZE - 1)];
+  SDL_AtomicSet(&_tail, t + 1);
+  return d;
+}
+
+/*!\brief arrête le thread de calcul et ferme le cache. */
+void psClean(void) {
+  if(_thread) {
+    SDL_AtomicSet(&_quit, 1);
+    SDL_WaitThread(_thread, NULL);
+    _thread = NULL;
+  }
+  if(_cache) {
+    fclose(_cache);
+    _cache = NULL;
+  }
+  if(_cacheName) {
+    free(_cacheName);
+    _cacheName = NULL;
+  }
+}
@@ -0,0 +1,17 @@
+#ifndef _PI_STREAM_H
+
+#define _PI_STREAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  extern void psInit(const char * cache);
+  extern int  psNext(void);
+  extern void psClean(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -3,6 +3,7 @@
 #include <assert.h>
 
 static void quit(void) {
+  mobileDelete();
   gl4duClean(GL4DU_ALL);
 }
 
@@ -0,0 +1,111 @@
+#include "pickHelper.h"
+#include <assert.h>
+#include <stdlib.h>
+
+/*!\brief nombre de lectures pouvant être en attente du GPU */
+#define PK_RING 4
+
+/*!\brief anneau de pixel buffers (GL_PIXEL_PACK_BUFFER) recevant le
+ * pixel désigné, chacun protégé par une barrière : glReadPixels vers un
+ * buffer ne fait qu'ajouter une copie aux commandes, la valeur est lue
+ * quelques frames plus tard, une fois la copie faite. */
+struct pkRing_t {
+  GLuint buffer[PK_RING];
+  GLsync fence[PK_RING];
+  /*!\brief frame et date de chaque demande */
+  int frame[PK_RING];
+  double t0[PK_RING];
+  /*!\brief région à remplir, plus ancienne région en attente et
+   * nombre de régions en attente */
+  int next, first, pending;
+  /*!\brief nombre d'appels à pkPoll, un par frame */
+  int frames;
+  pkCallback_t callback;
+  void * data;
+};
+
+/*!\brief crée un anneau dont les identifiants lus seront passés à
+ * \a callback avec \a data. */
+pkRing_t * pkNew(pkCallback_t callback, void * data) {
+  int i;
+  pkRing_t * r = calloc(1, sizeof *r);
+  assert(r);
+  r->callback = callback;
+  r->data = data;
+  glGenBuffers(PK_RING, r->buffer);
+  for(i = 0; i < PK_RING; i++) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, r->buffer[i]);
+    glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(GLfloat), NULL, GL_STREAM_READ);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  return r;
+}
+
+/*!\brief demande la lecture du pixel (\a x, \a y) de l'attachement
+ * \a attachment (une texture GL_R32F d'identifiants) du framebuffer lié
+ * en lecture. Rien n'est attendu ici ; le buffer de lecture est
+ * restauré.
+ * \return 0 si toutes les régions sont encore en attente (la demande
+ * est alors ignorée), 1 sinon.
+ */
+int pkRequest(pkRing_t * r, GLenum attachment, int x, int y) {
+  GLint readBuffer;
+  int i = r->next;
+  if(r->pending == PK_RING)
+    return 0;
+  glGetIntegerv(GL_READ_BUFFER, &readBuffer);
+  glReadBuffer(attachment);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, r->buffer[i]);
+  glReadPixels(x, y, 1, 1, GL_RED, GL_FLOAT, (GLvoid *)0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  glReadBuffer(readBuffer);
+  r->fence[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  r->frame[i] = r->frames;
+  r->t0[i] = gl4dGetElapsedTime();
+  r->next = (i + 1) % PK_RING;
+  r->pending++;
+  return 1;
+}
+
+/*!\brief à appeler une fois par frame : livre, dans l'ordre des
+ * demandes, les identifiants dont la copie est terminée. Les barrières
+ * sont testées sans attente (l'échange des buffers suffit à les
+ * envoyer au GPU).
+ * \return le nombre d'identifiants livrés.
+ */
+int pkPoll(pkRing_t * r) {
+  int i, n = 0;
+  GLfloat * p, id;
+  r->frames++;
+  while(r->pending) {
+    i = r->first;
+    if(glClientWaitSync(r->fence[i], 0, 0) == GL_TIMEOUT_EXPIRED)
+      break;
+    glDeleteSync(r->fence[i]);
+    r->fence[i] = 0;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, r->buffer[i]);
+    if((p = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof *p, GL_MAP_READ_BIT)) != NULL) {
+      id = *p;
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else
+      id = 0.0f;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    r->first = (i + 1) % PK_RING;
+    r->pending--;
+    r->callback((GLuint)(id + 0.5f), r->frames - r->frame[i], gl4dGetElapsedTime() - r->t0[i], r->data);
+    n++;
+  }
+  return n;
+}
+
+/*!\brief libère l'anneau \a r ; les demandes en attente sont
+ * abandonnées. */
+void pkDelete(pkRing_t * r) {
+  int i;
+  if(!r) return;
+  for(i = 0; i < PK_RING; i++)
+    if(r->fence[i])
+      glDeleteSync(r->fence[i]);
+  glDeleteBuffers(PK_RING, r->buffer);
+  free(r);
+}
@@ -0,0 +1,26 @@
+#ifndef _PICK_HELPER_H
+
+#define _PICK_HELPER_H
+
+#include <GL4D/gl4du.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  typedef struct pkRing_t pkRing_t;
+
+  /*!\brief reçoit l'identifiant lu, le nombre de frames et le temps
+   * (en millisecondes) écoulés depuis la demande */
+  typedef void (* pkCallback_t)(GLuint id, int frames, double ms, void * data);
+
+  extern pkRing_t * pkNew(pkCallback_t callback, void * data);
+  extern int        pkRequest(pkRing_t * r, GLenum attachment, int x, int y);
+  extern int        pkPoll(pkRing_t * r);
+  extern void       pkDelete(pkRing_t * r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
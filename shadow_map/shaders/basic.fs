@@ -17,6 +17,8 @@ float ring(vec2 p) {
 }
 
 void main(void) {
+  /* identifiant lu par le picking (texture GL_R32F) */
+  fragId = vec4(float(id), 0, 0, 1);
   if(id == 2) {
     fragColor = vec4(1, 1, 0.5, 1);
   } else {
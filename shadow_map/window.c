@@ -5,10 +5,13 @@
 #include <GL4D/gl4du.h>
 #include <GL4D/gl4duw_SDL2.h>
 #include "mobile.h"
+#include "pickHelper.h"
 
 static void init(void);
 static void draw(void);
 static void quit(void);
+static void mouse(int button, int state, int x, int y);
+static void picked(GLuint id, int frames, double ms, void * data);
 /*!\brief dimensions de la fenêtre */
 static int _windowWidth = 800, _windowHeight = 600;
 /*!\brief identifiant du programme de coloriage GLSL */
@@ -31,6 +34,10 @@ static GLuint _idTex = 0;
 static GLuint _smTex = 0;
 /*!\brief position de la lumière, relative aux objets */
 static GLfloat _lumpos[] = { -9, 9, 0, 1 };
+/*!\brief lectures asynchrones des identifiants d'objets */
+static pkRing_t * _pick = NULL;
+/*!\brief pixel à lire à la prochaine frame (repère OpenGL), -1 sinon */
+static int _pickX = -1, _pickY = -1;
 #define SHADOW_MAP_SIDE 512
 
 /*!\brief La fonction principale créé la fenêtre d'affichage,
@@ -42,6 +49,7 @@ int main(int argc, char ** argv) {
   init();
   atexit(quit);
   gl4duwIdleFunc(mobileMove);
+  gl4duwMouseFunc(mouse);
   gl4duwDisplayFunc(draw);
   gl4duwMainLoop();
   return 0;
@@ -101,6 +109,22 @@ static void init(void) {
 
   /* Création du Framebuffer Object */
   glGenFramebuffers(1, &_fbo);
+  _pick = pkNew(picked, NULL);
+}
+
+/*!\brief un clic gauche demande l'identifiant de l'objet sous le
+ * curseur ; il sera lu à la prochaine frame et livré à picked. */
+static void mouse(int button, int state, int x, int y) {
+  if(button != SDL_BUTTON_LEFT || state != SDL_PRESSED)
+    return;
+  _pickX = x;
+  _pickY = _windowHeight - 1 - y;
+}
+
+/*!\brief reçoit l'identifiant d'objet demandé \a frames frames (\a ms
+ * millisecondes) plus tôt ; 0 pour le fond. */
+static void picked(GLuint id, int frames, double ms, void * data) {
+  printf("picking : objet %u (reçu après %d frame%s, %.1f ms)\n", id, frames, frames > 1 ? "s" : "", ms);
 }
 
 /*!\brief la scène est soit dessinée du point de vu de la lumière (sm
@@ -158,6 +182,8 @@ static inline void scene(GLboolean sm) {
 /*!\brief dessine dans le contexte OpenGL actif. */
 static void draw(void) {
   GLenum renderings[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+  /* livre les identifiants déjà copiés, sans attendre les autres */
+  pkPoll(_pick);
   glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
   /* désactiver le rendu de couleur et ne laisser que le depth, dans _smTex */
   glDrawBuffer(GL_NONE);
@@ -185,6 +211,11 @@ static void draw(void) {
 
   scene(GL_FALSE);
 
+  /* copie asynchrone du pixel cliqué de _idTex */
+  if(_pickX >= 0 && _pickX < _windowWidth && _pickY >= 0 && _pickY < _windowHeight)
+    pkRequest(_pick, GL_COLOR_ATTACHMENT1, _pickX, _pickY);
+  _pickX = -1;
+
   /* copie du fbo à l'écran */
   glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
   glBlitFramebuffer(0, 0, _windowWidth, _windowHeight, 0, 0, _windowWidth, _windowHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
@@ -199,6 +230,8 @@ static void quit(void) {
     glDeleteTextures(1, &_smTex);
     glDeleteFramebuffers(1, &_fbo);
     _fbo = 0;
+    pkDelete(_pick);
+    _pick = NULL;
   }
   gl4duClean(GL4DU_ALL);
 }
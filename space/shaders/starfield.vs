@@ -0,0 +1,13 @@
+#version 330
+uniform vec2 dim;
+layout (location = 0) in float vsiPX;
+layout (location = 1) in float vsiPY;
+layout (location = 2) in float vsiSX;
+layout (location = 3) in float vsiSY;
+
+void main(void) {
+  /* une instance par étoile : le sommet 0 est la position
+   * d'apparition, le sommet 1 la position courante */
+  vec2 p = gl_VertexID == 0 ? vec2(vsiPX, vsiPY) : vec2(vsiSX, vsiSY);
+  gl_Position = vec4(2.0 * p / dim - 1.0, 0.0, 1.0);
+}
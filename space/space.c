@@ -1,8 +1,9 @@
 #include "space.h"
+#include "starfield.h"
 
 static int _w = 0, _h = 0;
-static line * _line = NULL;
-static int _nbLines = 300;
+static int _nbLines = 1000000;
+static int _nbSpiral = 300;
 
 static GLuint _white = RGB(255, 255, 255);
 static GLuint _black = RGB(0, 0, 0);
@@ -10,32 +11,10 @@ static GLuint _black = RGB(0, 0, 0);
 static mobile_t _mobile;
 
 
-static float myRand(float max) {
-  float rand = gl4dmURand() * max;
-  float sgn = gl4dmURand() * 2.0;
-  sgn = sgn > 1.0 ? 1.0 : -1.0;
-  rand *= sgn;
-  return rand;
-}
-
 void spaceInit(int w, int h) {
-  int i;
   _w = w; _h = h;
 
-  if(_line) {
-    free(_line);
-    _line = NULL;
-  }
-
-  _line = malloc(_nbLines * sizeof * _line);
-  assert(_line);
-
-  for(i = 0; i < _nbLines; i++) {
-    _line[i].x = myRand(_w);
-    _line[i].y = myRand(_h);
-    _line[i].z = gl4dmURand() * _w;
-    _line[i].pz = _line[i].z;
-  }
+  sfInit(_nbLines, _w, _h);
 
   _mobile.x = _w/2;
   _mobile.y = _h/2;
@@ -44,18 +23,8 @@ void spaceInit(int w, int h) {
 }
 
 static void lineMove(void) {
-  int i;
   float speed = 3;
-
-  for(i = 0; i < _nbLines; i++) {
-    _line[i].z -= speed;
-    if(_line[i].z < 1) {
-      _line[i].z = _w;
-      _line[i].x = myRand(_w);
-      _line[i].y = myRand(_h);
-      _line[i].pz = _line[i].z; 
-    }
-  }
+  sfUpdate(speed);
 }
 
 static void mobileMove(float basses) {
@@ -81,9 +50,9 @@ static void spiralDraw(void) {
   float y, ly = y = _h/2;
   float theta, radius;
 
-  for(i = 0.0; i < _nbLines; i += 1.0) {
+  for(i = 0.0; i < _nbSpiral; i += 1.0) {
     theta = angle * i;
-    radius = maxRadius * sqrt(i/_nbLines);
+    radius = maxRadius * sqrt(i/_nbSpiral);
     x = _w/2 + radius * cos(theta);
     y = _h/2 + radius * sin(theta);
     gl4dpSetColor(_black);
@@ -96,27 +65,17 @@ static void spiralDraw(void) {
 }
 
 static void lineDraw(void) {
-  int i;
-  float sx, sy, px, py;
-  gl4dpSetColor(_white); 
-  for(i = 0; i < _nbLines; i++) {
-    sx = (_line[i].x / _line[i].z) * _w + _w/2;
-    sy = (_line[i].y / _line[i].z) * _h + _h/2;
-    px = (_line[i].x / _line[i].pz) * _w + _w/2;
-    py = (_line[i].y / _line[i].pz) * _h + _h/2;
-    gl4dpLine(px, py, sx, sy);
-  }
+  /* les traînées sont dessinées par le GPU, par-dessus l'écran gl4dp */
+  sfDraw(_white);
 }
 
 void spaceDraw(void) {
   mobileDraw();
   spiralDraw();
+  gl4dpUpdateScreen(NULL);
   lineDraw();
 }
 
 void spaceDelete(void) {
-  if(_line) {
-    free(_line);
-    _line = NULL;
-  }
+  sfDelete();
 }
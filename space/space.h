@@ -18,12 +18,6 @@ struct mobile_t {
   GLuint c;
 };
 
-typedef struct line line;
-struct line {
-  float x, y, z, pz;
-  GLuint c;
-};
-
 extern void spaceInit(int w, int h);
 extern void spaceDelete(void);
 extern void spaceMove(float basses);
@@ -0,0 +1,20 @@
+#ifndef _STARFIELD_H
+
+#define _STARFIELD_H
+
+#include <GL4D/gl4du.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  extern void sfInit(int n, int w, int h);
+  extern void sfUpdate(float speed);
+  extern void sfDraw(GLuint color);
+  extern void sfDelete(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -35,7 +35,6 @@ static void quit(void) {
 static void draw(void) {
   gl4dpClearScreenWith(RGB(0, 0, 0));
  	spaceDraw();
-  gl4dpUpdateScreen(NULL);
 }
 
 static void idle(void) {
@@ -0,0 +1,13 @@
+#version 330
+
+/* région de la texture d'entrée écrite par la passe précédente */
+uniform vec2 inScale;
+layout (location = 0) in vec3 vsiPosition;
+layout (location = 2) in vec2 vsiTexCoord;
+
+out vec2 vsoTexCoord;
+
+void main(void) {
+  vsoTexCoord = vsiTexCoord * inScale;
+  gl_Position = vec4(vsiPosition, 1.0);
+}
@@ -0,0 +1,20 @@
+#version 330
+uniform sampler2D tex;
+uniform vec2 inScale;
+uniform vec2 dir;          // pas entre deux échantillons
+in  vec2 vsoTexCoord;
+out vec4 fragColor;
+
+/* noyau gaussien à 9 échantillons, appliqué en deux passes séparées */
+const float w[5] = float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
+
+void main(void) {
+  int i;
+  vec2 hi = inScale - 0.5 * dir;
+  vec4 c = w[0] * texture(tex, vsoTexCoord);
+  for(i = 1; i < 5; i++) {
+    c += w[i] * texture(tex, min(vsoTexCoord + i * dir, hi));
+    c += w[i] * texture(tex, max(vsoTexCoord - i * dir, 0.5 * dir));
+  }
+  fragColor = c;
+}
@@ -0,0 +1,15 @@
+#version 330
+uniform sampler2D tex;
+uniform vec2 inScale;
+uniform float param;       // angle au centre
+in  vec2 vsoTexCoord;
+out vec4 fragColor;
+
+void main(void) {
+  /* tourbillon autour du centre de l'écran */
+  vec2 vecteur = vsoTexCoord / inScale - vec2(0.5);
+  float distance = length(vecteur);
+  float angle = atan(vecteur.y, vecteur.x) + param / (1.0 + distance);
+  vec2 tc = vec2(0.5) + distance * vec2(cos(angle), sin(angle));
+  fragColor = texture(tex, clamp(tc, 0.0, 1.0) * inScale);
+}
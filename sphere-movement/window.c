@@ -6,6 +6,7 @@
 #include <GL4D/gl4duw_SDL2.h>
 #include <SDL_image.h>
 #include "sphere.h"
+#include "postHelper.h"
 
 /* Prototypes des fonctions statiques contenues dans ce fichier C */
 static void         initGL(void);
@@ -28,6 +29,11 @@ static GLuint _pause = 0;
 static GLuint _shift = GL_FALSE;
 /*!\brief flag pour activer le tourbillon */
 static GLuint _swirl = 0;
+/*!\brief flag pour activer le flou */
+static GLuint _blur = 0;
+/*!\brief post-traitement : tourbillon puis flou, en demi-résolution */
+static phChain_t * _post = NULL;
+static int _postSwirl = 0, _postBlur = 0;
 /*!\brief les différents modes de vue */
 static GLuint _mode = 0;
 /*!\brief modifier les dimensions de la sphère*/
@@ -42,6 +48,9 @@ static GLuint _tId[NB_SPH] = {0};
 static GLuint _sphere = {0};
 /*!\brief nombre de spheres */
 static int _nbSpheres = 100;
+/*!\brief positions, rayons et textures des sphères, alloués une
+ * seule fois */
+static GLfloat * _f = NULL;
 
 /*!\brief La fonction principale créé la fenêtre d'affichage,
  * initialise GL et les données, affecte les fonctions d'événements et
@@ -72,6 +81,9 @@ static void initGL(void) {
   _pId  = gl4duCreateProgram("<vs>shaders/sphere.vs", "<fs>shaders/sphere.fs", NULL);
   gl4duGenMatrix(GL_FLOAT, "modelViewMatrix");
   gl4duGenMatrix(GL_FLOAT, "projectionMatrix");
+  _post = phNew();
+  _postSwirl = phAdd(_post, PH_SWIRL, 0.5f);
+  _postBlur = phAdd(_post, PH_BLUR, 0.5f);
   resize(_wW, _wH);
 }
 
@@ -106,6 +118,8 @@ static void initData(void) {
 
   _sphere = gl4dgGenSpheref(30, 30);
   mobileInit(_nbSpheres, NB_SPH-1, _wW, _wH);
+  _f = malloc(_nbSpheres * 8 * sizeof *_f);
+  assert(_f);
 }
 
 /*!\brief Cette fonction paramétre la vue (viewport) OpenGL en
@@ -138,6 +152,9 @@ static void keydown(int keycode) {
   case 'a':
     _rotate = !_rotate;
     break;
+  case 'b':
+    _blur = !_blur;
+    break;
   case 'g':
     _grow = !_grow;
     break;
@@ -176,10 +193,13 @@ static void keydown(int keycode) {
 static void draw(void) {
   int i;
   static float r = 0.0, s = 0.0, g = 0.2;
-  GLfloat * f = malloc(_nbSpheres * 8 * sizeof *f);
+  GLfloat * f = _f;
   GLfloat dt = 0.0;
   dt = SDL_GetTicks();
 
+  phSet(_post, _postSwirl, _swirl, phSwirlAngle(5.0f / pow(10, _swirl), 1.0f, dt));
+  phSet(_post, _postBlur, _blur, 1.0f);
+  phBegin(_post);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   gl4duBindMatrix("modelViewMatrix");
   gl4duLoadIdentityf();
@@ -196,8 +216,6 @@ static void draw(void) {
   glActiveTexture(GL_TEXTURE1);
   glBindTexture(GL_TEXTURE_2D, _tId[1]);
   glUniform1i(glGetUniformLocation(_pId, "tex0"), 0);
-  glUniform1i(glGetUniformLocation(_pId, "temps"), dt);
-  glUniform1i(glGetUniformLocation(_pId, "swirl"), _swirl);
 
   /* envoi de toutes les matrices stockées par GL4D */
   mobile2texture(f);
@@ -211,7 +229,6 @@ static void draw(void) {
   gl4dgDraw(_sphere);
   glActiveTexture(GL_TEXTURE1);
   glBindTexture(GL_TEXTURE_2D, 0);
-  glUniform1i(glGetUniformLocation(_pId, "swirl"), 0);
 
   for(i = 1; i < _nbSpheres; i++) {
     int id = f[8 * i + 3];
@@ -224,6 +241,7 @@ static void draw(void) {
     } gl4duPopMatrix();
     gl4dgDraw(_sphere);
   }
+  phEnd(_post);
 
   if(_scale)
     s += .01;
@@ -239,7 +257,13 @@ static void draw(void) {
 
 /*!\brief appelée au moment de sortir du programme (atexit), libère les éléments utilisés */
 static void quit(void) {
+  phDelete(_post);
+  _post = NULL;
   mobileClean();
+  if(_f) {
+    free(_f);
+    _f = NULL;
+  }
   gl4duClean(GL4DU_ALL);
 }
 